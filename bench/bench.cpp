@@ -0,0 +1,383 @@
+// ワールド・メッシュ生成・セーブの速さを測る (ウィンドウも音も使わない)
+//
+//   MasoGradation_bench            10k, 1M, 100M ボクセル
+//   MasoGradation_bench --quick    10k, 1M だけ
+//   MasoGradation_bench 250000 ... 好きなボクセル数
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "jobsystem.hpp"
+#include "mesher.hpp"
+#include "physics.hpp"
+#include "raycast.hpp"
+#include "terrain.hpp"
+#include "world.hpp"
+#include "worldio.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedNs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// 1 サンプル = opsPerSample 回ぶんの時間
+struct Samples {
+    std::vector<double> ns;
+    double opsPerSample = 1.0;
+
+    void add(double sampleNs) { ns.push_back(sampleNs); }
+
+    void report(const char* name, long long voxels, const char* unit)
+    {
+        if (ns.empty()) return;
+        std::vector<double> perOp;
+        perOp.reserve(ns.size());
+        double total = 0.0;
+        for (double v : ns)
+        {
+            total += v;
+            perOp.push_back(v / opsPerSample);
+        }
+        std::sort(perOp.begin(), perOp.end());
+        auto pct = [&](double p) {
+            size_t i = static_cast<size_t>(p * (perOp.size() - 1) + 0.5);
+            return perOp[i];
+        };
+        double ops = ns.size() * opsPerSample;
+        std::printf("%-16s %11lld  %12.3e %-9s  p50 %10.1f  p90 %10.1f  p99 %10.1f  max %10.1f ns/%s\n",
+                    name, voxels, ops / (total * 1e-9), (std::string(unit) + "/s").c_str(),
+                    pct(0.50), pct(0.90), pct(0.99), perOp.back(), unit);
+    }
+};
+
+// 並べ替え用: i -> (i * stride) mod n は stride と n が互いに素なら全単射
+std::uint64_t coprimeStride(std::uint64_t n)
+{
+    std::uint64_t stride = 2654435761ull % n;
+    if (stride == 0) stride = 1;
+    while (std::gcd(stride, n) != 1) stride++;
+    return stride;
+}
+
+// 地形っぽいブロック (石・土・草・空気) を座標から決める
+BlockId terrainType(int x, int y, int z, int side)
+{
+    float h = side * 0.5f + 4.0f * sinf(x * 0.1f) + 4.0f * cosf(z * 0.13f);
+    if (y < h - 3.0f) return 1;
+    if (y < h - 1.0f) return 2;
+    if (y < h) return 3;
+    return BLOCK_AIR;
+}
+
+void benchSetGet(World& world, int side, long long voxels)
+{
+    const std::uint64_t n = static_cast<std::uint64_t>(side) * side * side;
+    const std::uint64_t stride = coprimeStride(n);
+    const int batch = 4096;
+
+    Samples set;
+    set.opsPerSample = batch;
+    std::uint64_t i = 0;
+    while (i + batch <= n)
+    {
+        Clock::time_point start = Clock::now();
+        for (int k = 0; k < batch; k++, i++)
+        {
+            std::uint64_t p = (i * stride) % n;
+            int x = static_cast<int>(p % side);
+            int z = static_cast<int>((p / side) % side);
+            int y = static_cast<int>(p / (static_cast<std::uint64_t>(side) * side));
+            world.setBlock(x, y, z, terrainType(x, y, z, side));
+        }
+        set.add(elapsedNs(start));
+    }
+    for (; i < n; i++)
+    {
+        int x = static_cast<int>(i % side);
+        int z = static_cast<int>((i / side) % side);
+        int y = static_cast<int>(i / (static_cast<std::uint64_t>(side) * side));
+        world.setBlock(x, y, z, terrainType(x, y, z, side));
+    }
+    set.report("block set", voxels, "op");
+
+    Samples get;
+    get.opsPerSample = batch;
+    std::uint64_t checksum = 0;
+    for (i = 0; i + batch <= n; )
+    {
+        Clock::time_point start = Clock::now();
+        for (int k = 0; k < batch; k++, i++)
+        {
+            std::uint64_t p = (i * stride) % n;
+            checksum += world.getBlock(static_cast<int>(p % side),
+                                       static_cast<int>(p / (static_cast<std::uint64_t>(side) * side)),
+                                       static_cast<int>((p / side) % side));
+        }
+        get.add(elapsedNs(start));
+    }
+    get.report("block get", voxels, "op");
+    if (checksum == 1) std::printf("\n"); // 最適化で消されないように
+}
+
+void benchRemesh(const World& world, long long voxels)
+{
+    const size_t maxChunks = 2000;
+    PaddedChunk padded;
+    ChunkMeshData mesh;
+    Samples samples;
+    long long triangles = 0;
+    size_t count = 0;
+    for (const auto& entry : world.allChunks())
+    {
+        if (count++ >= maxChunks) break;
+        Clock::time_point start = Clock::now();
+        gatherPaddedChunk(world, entry.first, padded);
+        greedyMesh(padded, mesh);
+        samples.add(elapsedNs(start));
+        triangles += mesh.triangleCount();
+    }
+    samples.report("chunk remesh", voxels, "chunk");
+    std::printf("%-16s %11lld  %lld triangles in %zu chunks\n", "", voxels, triangles, samples.ns.size());
+}
+
+void benchRaycast(const World& world, int side, long long voxels)
+{
+    // 立方体の中の適当な点から適当な向きに。1 バッチ = 1 サンプル
+    const int batch = 1024;
+    const int batches = 64;
+    std::uint32_t state = 12345;
+    auto random = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / static_cast<float>(1 << 24);
+    };
+    std::vector<VoxelRay> rays(batch);
+    std::vector<RayHit> hits;
+    Samples single;
+    Samples batched;
+    single.opsPerSample = batch;
+    batched.opsPerSample = batch;
+    long long hitCount = 0;
+    for (int b = 0; b < batches; b++)
+    {
+        for (VoxelRay& ray : rays)
+        {
+            ray = { random() * side, random() * side, random() * side,
+                    random() - 0.5f, random() - 0.5f, random() - 0.5f, static_cast<float>(side) };
+        }
+        Clock::time_point start = Clock::now();
+        for (const VoxelRay& ray : rays) hitCount += raycastVoxels(world, ray).hit;
+        single.add(elapsedNs(start));
+
+        start = Clock::now();
+        raycastVoxels(world, rays, hits);
+        batched.add(elapsedNs(start));
+    }
+    single.report("raycast", voxels, "ray");
+    batched.report("raycast batch", voxels, "ray");
+    std::printf("%-16s %11lld  %.1f%% hit\n", "", voxels, 100.0 * hitCount / (batch * batches));
+}
+
+void benchPhysics(const World& world, int side, long long voxels)
+{
+    // 立方体の上のほうから落として歩かせる。1 tick = 1 サンプル
+    const int bodyCount = 1024;
+    const int ticks = 120;
+    const float dt = 1.0f / 60.0f;
+    std::uint32_t state = 777;
+    auto random = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / static_cast<float>(1 << 24);
+    };
+    std::vector<PhysicsBody> bodies(bodyCount);
+    for (PhysicsBody& body : bodies)
+    {
+        body.x = random() * side;
+        body.y = side * (0.5f + 0.5f * random());
+        body.z = random() * side;
+    }
+    Physics physics;
+    Samples samples;
+    samples.opsPerSample = bodyCount;
+    std::size_t tested = 0;
+    int grounded = 0;
+    for (int t = 0; t < ticks; t++)
+    {
+        for (PhysicsBody& body : bodies)
+        {
+            body.velocityX = 4.0f * (random() - 0.5f);
+            body.velocityZ = 4.0f * (random() - 0.5f);
+        }
+        Clock::time_point start = Clock::now();
+        physics.step(world, bodies.data(), bodies.size(), dt);
+        samples.add(elapsedNs(start));
+        tested += physics.testedBoxes();
+    }
+    for (const PhysicsBody& body : bodies) grounded += body.onGround;
+    samples.report("physics step", voxels, "body");
+    std::printf("%-16s %11lld  %.1f boxes/body, %.1f%% on ground\n", "", voxels,
+                static_cast<double>(tested) / (static_cast<double>(bodyCount) * ticks), 100.0 * grounded / bodyCount);
+}
+
+void benchSaveLoad(World& world, long long voxels, int repeats)
+{
+    // 作業ディレクトリを汚さないように一時ディレクトリに書く
+    const std::string path = (std::filesystem::temp_directory_path() / "bench_world.mgw").string();
+    Samples save;
+    Samples load;
+    Samples incremental;
+    std::uint64_t bytes = 0;
+
+    for (int r = 0; r < repeats; r++)
+    {
+        std::remove(path.c_str());
+
+        // 全チャンクを書く (最初のセーブ)
+        std::vector<ChunkSnapshot> all;
+        all.reserve(world.chunkCount());
+        for (const auto& entry : world.allChunks())
+        {
+            all.push_back({ entry.first, entry.second->blocks });
+        }
+        {
+            WorldFile file(path);
+            Clock::time_point start = Clock::now();
+            file.writeChunks(all);
+            save.add(elapsedNs(start));
+            bytes = file.fileBytes();
+        }
+
+        // 読み込み (mmap + 全チャンク展開)
+        {
+            WorldFile file(path);
+            World loaded;
+            Clock::time_point start = Clock::now();
+            file.open();
+            loaded.setSource(&file);
+            loaded.loadAllChunks();
+            load.add(elapsedNs(start));
+            if (loaded.blockCount() != world.blockCount()) std::printf("load mismatch!\n");
+
+            // 1% のチャンクだけ変えて差分セーブ
+            std::vector<ChunkSnapshot> dirty;
+            size_t step = std::max<size_t>(1, all.size() / 100);
+            for (size_t i = 0; i < all.size(); i += step)
+            {
+                ChunkSnapshot snap = all[i];
+                snap.blocks[0] = snap.blocks[0] == 1 ? 2 : 1;
+                dirty.push_back(snap);
+            }
+            Clock::time_point startIncremental = Clock::now();
+            file.writeChunks(dirty);
+            incremental.add(elapsedNs(startIncremental));
+        }
+    }
+    std::remove(path.c_str());
+
+    save.opsPerSample = static_cast<double>(world.chunkCount());
+    load.opsPerSample = static_cast<double>(world.chunkCount());
+    save.report("full save", voxels, "chunk");
+    load.report("load", voxels, "chunk");
+    incremental.report("1% save", voxels, "save");
+    std::printf("%-16s %11lld  %zu chunks, %.2f MB on disk\n", "", voxels, world.chunkCount(), bytes / 1048576.0);
+}
+
+void benchGenerate(long long voxels, int side)
+{
+    // ゲームと同じ地形生成。チャンク 1 つが 1 サンプル
+    TerrainGenerator terrain;
+    int chunksPerSide = (side + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    Samples samples;
+    Chunk chunk;
+    std::uint64_t checksum = 0;
+    for (int cy = 0; cy < chunksPerSide; cy++)
+    for (int cz = 0; cz < chunksPerSide; cz++)
+    for (int cx = 0; cx < chunksPerSide; cx++)
+    {
+        Clock::time_point start = Clock::now();
+        terrain.generateChunk({ cx, cy, cz }, chunk);
+        samples.add(elapsedNs(start));
+        checksum += chunk.solidCount;
+    }
+    samples.report("generate", voxels, "chunk");
+
+    // 同じものをジョブシステムで (全部終わるまでの時間で割る)
+    JobSystem jobs;
+    std::atomic<std::uint64_t> parallelChecksum{ 0 };
+    Clock::time_point start = Clock::now();
+    for (int cy = 0; cy < chunksPerSide; cy++)
+    for (int cz = 0; cz < chunksPerSide; cz++)
+    for (int cx = 0; cx < chunksPerSide; cx++)
+    {
+        jobs.run("generate", 0.0f, [&terrain, &parallelChecksum, cx, cy, cz]() -> std::function<void()> {
+            Chunk generated;
+            terrain.generateChunk({ cx, cy, cz }, generated);
+            parallelChecksum += generated.solidCount;
+            return nullptr;
+        });
+    }
+    while (jobs.pending() > 0)
+    {
+        jobs.poll();
+        std::this_thread::yield();
+    }
+    Samples parallel;
+    parallel.opsPerSample = static_cast<double>(samples.ns.size());
+    parallel.add(elapsedNs(start));
+    char name[32];
+    std::snprintf(name, sizeof(name), "generate x%d", jobs.threadCount());
+    parallel.report(name, voxels, "chunk");
+    if (checksum != parallelChecksum) std::printf("generate mismatch!\n");
+}
+
+void runSize(long long voxels)
+{
+    int side = static_cast<int>(std::lround(std::cbrt(static_cast<double>(voxels))));
+    if (side < 1) side = 1;
+    long long actual = static_cast<long long>(side) * side * side;
+    std::printf("--- %lld voxels (%d^3) ---\n", actual, side);
+
+    World world;
+    benchSetGet(world, side, actual);
+    benchRemesh(world, actual);
+    benchRaycast(world, side, actual);
+    benchPhysics(world, side, actual);
+    benchSaveLoad(world, actual, actual > 10000000 ? 1 : 5);
+    benchGenerate(actual, side);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::vector<long long> sizes;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--quick" || arg == "-q") quick = true;
+        else sizes.push_back(std::atoll(arg.c_str()));
+    }
+    if (sizes.empty())
+    {
+        sizes = { 10000, 1000000 };
+        if (!quick) sizes.push_back(100000000);
+    }
+
+    for (long long voxels : sizes) runSize(voxels);
+    return 0;
+}
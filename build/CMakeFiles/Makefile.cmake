@@ -1,56 +0,0 @@
-# CMAKE generated file: DO NOT EDIT!
-# Generated by "Unix Makefiles" Generator, CMake Version 4.0
-
-# The generator used is:
-set(CMAKE_DEPENDS_GENERATOR "Unix Makefiles")
-
-# The top level Makefile was generated from the following files:
-set(CMAKE_MAKEFILE_DEPENDS
-  "CMakeCache.txt"
-  "/home/kitanohideaki/Documents/git/MasoGradation/CMakeLists.txt"
-  "CMakeFiles/4.0.0/CMakeCXXCompiler.cmake"
-  "CMakeFiles/4.0.0/CMakeSystem.cmake"
-  "/usr/lib/cmake/raylib/raylib-config-version.cmake"
-  "/usr/lib/cmake/raylib/raylib-config.cmake"
-  "/usr/share/cmake/Modules/CMakeCXXInformation.cmake"
-  "/usr/share/cmake/Modules/CMakeCommonLanguageInclude.cmake"
-  "/usr/share/cmake/Modules/CMakeGenericSystem.cmake"
-  "/usr/share/cmake/Modules/CMakeInitializeConfigs.cmake"
-  "/usr/share/cmake/Modules/CMakeLanguageInformation.cmake"
-  "/usr/share/cmake/Modules/CMakeSystemSpecificInformation.cmake"
-  "/usr/share/cmake/Modules/CMakeSystemSpecificInitialize.cmake"
-  "/usr/share/cmake/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
-  "/usr/share/cmake/Modules/Compiler/GNU-CXX.cmake"
-  "/usr/share/cmake/Modules/Compiler/GNU.cmake"
-  "/usr/share/cmake/Modules/FindPackageHandleStandardArgs.cmake"
-  "/usr/share/cmake/Modules/FindPackageMessage.cmake"
-  "/usr/share/cmake/Modules/FindPkgConfig.cmake"
-  "/usr/share/cmake/Modules/Internal/CMakeCXXLinkerInformation.cmake"
-  "/usr/share/cmake/Modules/Internal/CMakeCommonLinkerInformation.cmake"
-  "/usr/share/cmake/Modules/Linker/GNU-CXX.cmake"
-  "/usr/share/cmake/Modules/Linker/GNU.cmake"
-  "/usr/share/cmake/Modules/Platform/Linker/GNU.cmake"
-  "/usr/share/cmake/Modules/Platform/Linker/Linux-GNU-CXX.cmake"
-  "/usr/share/cmake/Modules/Platform/Linker/Linux-GNU.cmake"
-  "/usr/share/cmake/Modules/Platform/Linux-GNU-CXX.cmake"
-  "/usr/share/cmake/Modules/Platform/Linux-GNU.cmake"
-  "/usr/share/cmake/Modules/Platform/Linux-Initialize.cmake"
-  "/usr/share/cmake/Modules/Platform/Linux.cmake"
-  "/usr/share/cmake/Modules/Platform/UnixPaths.cmake"
-  )
-
-# The corresponding makefile is:
-set(CMAKE_MAKEFILE_OUTPUTS
-  "Makefile"
-  "CMakeFiles/cmake.check_cache"
-  )
-
-# Byproducts of CMake generate step:
-set(CMAKE_MAKEFILE_PRODUCTS
-  "CMakeFiles/CMakeDirectoryInformation.cmake"
-  )
-
-# Dependency information for all targets:
-set(CMAKE_DEPEND_INFO_FILES
-  "CMakeFiles/MasoGradation.dir/DependInfo.cmake"
-  )
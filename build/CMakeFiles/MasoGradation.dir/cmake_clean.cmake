@@ -1,12 +0,0 @@
-file(REMOVE_RECURSE
-  "CMakeFiles/MasoGradation.dir/link.d"
-  "CMakeFiles/MasoGradation.dir/src/main.cpp.o"
-  "CMakeFiles/MasoGradation.dir/src/main.cpp.o.d"
-  "MasoGradation"
-  "MasoGradation.pdb"
-)
-
-# Per-language clean rules from dependency scanning.
-foreach(lang CXX)
-  include(CMakeFiles/MasoGradation.dir/cmake_clean_${lang}.cmake OPTIONAL)
-endforeach()
@@ -0,0 +1,37 @@
+#version 330
+
+in vec2 fragTexCoord;
+in vec4 fragColor;
+flat in int fragTile;
+
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+// x: 列数, y: タイルの画素数, z: 周りの余白の画素数, w: 使ってよい最大のミップレベル
+uniform vec4 atlasLayout;
+// アトラス全体の画素数
+uniform vec2 atlasSize;
+
+out vec4 finalColor;
+
+void main()
+{
+    float columns = atlasLayout.x;
+    float tilePixels = atlasLayout.y;
+    float padding = atlasLayout.z;
+    float cell = tilePixels + 2.0*padding;
+
+    // 面の中でタイルを繰り返す
+    vec2 cellOrigin = vec2(mod(float(fragTile), columns), floor(float(fragTile)/columns))*cell + padding;
+    vec2 uv = (cellOrigin + fract(fragTexCoord)*tilePixels)/atlasSize;
+
+    // fract の境目でミップレベルが跳ねないよう、繰り返す前の座標から決める
+    // 余白より粗いレベルは隣のタイルが混ざるので使わない
+    vec2 texel = fragTexCoord*tilePixels;
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float lod = 0.5*log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8));
+    vec4 texelColor = textureLod(texture0, uv, clamp(lod, 0.0, atlasLayout.w));
+
+    finalColor = texelColor*colDiffuse*fragColor;
+}
@@ -0,0 +1,21 @@
+#version 330
+
+// チャンク用。texcoords2 の x にアトラスのタイル番号が入っている
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec2 vertexTexCoord2;
+in vec4 vertexColor;
+
+uniform mat4 mvp;
+
+out vec2 fragTexCoord;
+out vec4 fragColor;
+flat out int fragTile;
+
+void main()
+{
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+    fragTile = int(vertexTexCoord2.x + 0.5);
+    gl_Position = mvp*vec4(vertexPosition, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 330
+
+// DrawMeshInstanced 用。インスタンスごとの行列は instanceTransform で受け取る
+in vec3 vertexPosition;
+in vec2 vertexTexCoord;
+in vec4 vertexColor;
+in mat4 instanceTransform;
+
+uniform mat4 mvp;
+
+out vec2 fragTexCoord;
+out vec4 fragColor;
+
+void main()
+{
+    fragTexCoord = vertexTexCoord;
+    fragColor = vertexColor;
+    gl_Position = mvp*instanceTransform*vec4(vertexPosition, 1.0);
+}
@@ -0,0 +1,445 @@
+#include "assetcache.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "profiler.hpp"
+
+namespace {
+
+// 形式を変えたら上げる (古いキャッシュは使われなくなる)
+constexpr std::uint32_t CACHE_VERSION = 1;
+constexpr char IMAGE_MAGIC[4] = { 'M', 'G', 'I', 'M' };
+constexpr char MESH_MAGIC[4] = { 'M', 'G', 'M', 'S' };
+
+constexpr std::uint64_t FNV_OFFSET = 1469598103934665603ull;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+
+std::uint64_t hashBytes(std::uint64_t hash, const void* data, std::size_t size)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash ^= p[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+bool readWholeFile(const std::string& path, std::vector<char>& out)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    out.resize(static_cast<std::size_t>(size));
+    return static_cast<bool>(file.read(out.data(), size));
+}
+
+// 途中で落ちても壊れたキャッシュが残らないよう、書いてから名前を変える
+bool writeWholeFile(const std::string& path, const std::vector<char>& data)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open() || !file.write(data.data(), static_cast<std::streamsize>(data.size()))) return false;
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+// キャッシュはこのマシンでしか使わないので、数値はそのままのバイト順で書く
+template <typename T>
+void append(std::vector<char>& out, const T& value)
+{
+    const char* p = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+void appendArray(std::vector<char>& out, const void* data, std::size_t size)
+{
+    const char* p = static_cast<const char*>(data);
+    out.insert(out.end(), p, p + size);
+}
+
+template <typename T>
+bool take(const std::vector<char>& in, std::size_t& pos, T& value)
+{
+    if (pos + sizeof(T) > in.size()) return false;
+    std::memcpy(&value, in.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+template <typename T>
+T* takeArray(const std::vector<char>& in, std::size_t& pos, std::size_t count)
+{
+    std::size_t size = count * sizeof(T);
+    if (pos + size > in.size()) return nullptr;
+    // UnloadMesh / UnloadImage が解放できるように MemAlloc で確保する
+    T* data = static_cast<T*>(MemAlloc(static_cast<unsigned int>(size)));
+    std::memcpy(data, in.data() + pos, size);
+    pos += size;
+    return data;
+}
+
+// ---------------------------------------------------------------------
+// OBJ の読み込み (v, vt, vn, f と mtllib の最初の Kd だけ)
+
+struct ObjMesh {
+    std::vector<float> vertices;
+    std::vector<float> texcoords;
+    std::vector<float> normals;
+    Color diffuse = WHITE;
+};
+
+const char* skipSpaces(const char* p)
+{
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+// "a", "a/b", "a//c", "a/b/c" (負の番号は後ろから)
+const char* parseFaceVertex(const char* p, int counts[3], int out[3])
+{
+    for (int k = 0; k < 3; k++) out[k] = -1;
+    for (int k = 0; k < 3; k++)
+    {
+        if (*p != '/')
+        {
+            char* end;
+            long value = std::strtol(p, &end, 10);
+            if (end == p) break;
+            out[k] = value < 0 ? counts[k] + static_cast<int>(value) : static_cast<int>(value) - 1;
+            p = end;
+        }
+        if (*p != '/') break;
+        p++;
+    }
+    return p;
+}
+
+Color readMtlDiffuse(const std::string& mtlPath)
+{
+    std::ifstream file(mtlPath);
+    std::string line;
+    while (std::getline(file, line))
+    {
+        float r, g, b;
+        const char* p = skipSpaces(line.c_str());
+        if (std::sscanf(p, "Kd %f %f %f", &r, &g, &b) == 3)
+        {
+            return { static_cast<unsigned char>(r * 255.0f), static_cast<unsigned char>(g * 255.0f),
+                     static_cast<unsigned char>(b * 255.0f), 255 };
+        }
+    }
+    return WHITE;
+}
+
+bool parseObj(const std::string& path, const std::vector<char>& source, ObjMesh& mesh)
+{
+    std::vector<float> positions;
+    std::vector<float> uvs;
+    std::vector<float> normals;
+    std::string text(source.begin(), source.end());
+    if (text.empty() || text.back() != '\n') text.push_back('\n');
+
+    std::size_t lineStart = 0;
+    while (lineStart < text.size())
+    {
+        std::size_t lineEnd = text.find('\n', lineStart);
+        text[lineEnd] = '\0';
+        const char* p = skipSpaces(text.c_str() + lineStart);
+        lineStart = lineEnd + 1;
+
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            char* end;
+            const char* q = p + 2;
+            for (int k = 0; k < 3; k++)
+            {
+                positions.push_back(std::strtof(q, &end));
+                q = end;
+            }
+        }
+        else if (p[0] == 'v' && p[1] == 't')
+        {
+            char* end;
+            float u = std::strtof(p + 2, &end);
+            float v = std::strtof(end, &end);
+            uvs.push_back(u);
+            uvs.push_back(1.0f - v); // raylib の OBJ 読み込みと同じく上下反転
+        }
+        else if (p[0] == 'v' && p[1] == 'n')
+        {
+            char* end;
+            const char* q = p + 2;
+            for (int k = 0; k < 3; k++)
+            {
+                normals.push_back(std::strtof(q, &end));
+                q = end;
+            }
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            int counts[3] = {
+                static_cast<int>(positions.size() / 3),
+                static_cast<int>(uvs.size() / 2),
+                static_cast<int>(normals.size() / 3),
+            };
+            std::vector<std::array<int, 3>> face;
+            p = skipSpaces(p + 1);
+            while (*p != '\0' && *p != '\r')
+            {
+                int idx[3];
+                const char* next = parseFaceVertex(p, counts, idx);
+                if (next == p || idx[0] < 0 || idx[0] >= counts[0]) break;
+                face.push_back({ idx[0], idx[1], idx[2] });
+                p = skipSpaces(next);
+            }
+            // 多角形は扇形に三角形へ
+            for (std::size_t i = 2; i < face.size(); i++)
+            {
+                const std::array<int, 3>* tri[3] = { &face[0], &face[i - 1], &face[i] };
+                for (const std::array<int, 3>* v : tri)
+                {
+                    const int* idx = v->data();
+                    mesh.vertices.insert(mesh.vertices.end(), &positions[idx[0] * 3], &positions[idx[0] * 3] + 3);
+                    if (idx[1] >= 0 && idx[1] < counts[1])
+                        mesh.texcoords.insert(mesh.texcoords.end(), &uvs[idx[1] * 2], &uvs[idx[1] * 2] + 2);
+                    else
+                        mesh.texcoords.insert(mesh.texcoords.end(), { 0.0f, 0.0f });
+                    if (idx[2] >= 0 && idx[2] < counts[2])
+                        mesh.normals.insert(mesh.normals.end(), &normals[idx[2] * 3], &normals[idx[2] * 3] + 3);
+                    else
+                        mesh.normals.insert(mesh.normals.end(), { 0.0f, 1.0f, 0.0f });
+                }
+            }
+        }
+        else if (std::strncmp(p, "mtllib", 6) == 0)
+        {
+            std::string name = skipSpaces(p + 6);
+            while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) name.pop_back();
+            mesh.diffuse = readMtlDiffuse((std::filesystem::path(path).parent_path() / name).string());
+        }
+    }
+    return !mesh.vertices.empty();
+}
+
+} // namespace
+
+bool hashFile(const std::string& path, std::uint64_t& hash)
+{
+    std::vector<char> data;
+    if (!readWholeFile(path, data)) return false;
+    hash = hashBytes(FNV_OFFSET, data.data(), data.size());
+    return true;
+}
+
+// =====================================================================
+// AssetCache
+
+AssetCache::AssetCache(std::string directory) : directory(std::move(directory)) {}
+
+std::string AssetCache::cachePath(const std::string& source, std::uint64_t hash, const char* extension) const
+{
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    std::string stem = std::filesystem::path(source).stem().string();
+    return directory + "/" + stem + "-" + hex + extension;
+}
+
+Image AssetCache::loadImage(const std::string& path, int width, int height) const
+{
+    Image image{};
+    std::vector<char> source;
+    if (!readWholeFile(path, source))
+    {
+        std::cerr << "ファイルを開けませんでした: " << path << std::endl;
+        return image;
+    }
+    std::uint64_t hash = hashBytes(FNV_OFFSET, source.data(), source.size());
+    int params[3] = { width, height, static_cast<int>(CACHE_VERSION) };
+    hash = hashBytes(hash, params, sizeof(params));
+    std::string baked = cachePath(path, hash, ".img");
+
+    std::vector<char> data;
+    if (readWholeFile(baked, data))
+    {
+        std::size_t pos = 4;
+        std::uint32_t version, w, h;
+        if (data.size() >= 4 && std::memcmp(data.data(), IMAGE_MAGIC, 4) == 0 &&
+            take(data, pos, version) && version == CACHE_VERSION && take(data, pos, w) && take(data, pos, h))
+        {
+            image.data = takeArray<unsigned char>(data, pos, static_cast<std::size_t>(w) * h * 4);
+            if (image.data)
+            {
+                image.width = static_cast<int>(w);
+                image.height = static_cast<int>(h);
+                image.mipmaps = 1;
+                image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+                return image;
+            }
+        }
+    }
+
+    // キャッシュが無い・古いので元ファイルから作る
+    std::string extension = std::filesystem::path(path).extension().string();
+    image = LoadImageFromMemory(extension.c_str(), reinterpret_cast<const unsigned char*>(source.data()),
+                                static_cast<int>(source.size()));
+    if (image.data == nullptr) return image;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if (width > 0 && height > 0) ImageResize(&image, width, height);
+
+    std::vector<char> out(IMAGE_MAGIC, IMAGE_MAGIC + 4);
+    append(out, CACHE_VERSION);
+    append(out, static_cast<std::uint32_t>(image.width));
+    append(out, static_cast<std::uint32_t>(image.height));
+    appendArray(out, image.data, static_cast<std::size_t>(image.width) * image.height * 4);
+    writeWholeFile(baked, out);
+    return image;
+}
+
+Mesh AssetCache::loadMesh(const std::string& objPath, Color* diffuse) const
+{
+    Mesh mesh{};
+    std::vector<char> source;
+    if (!readWholeFile(objPath, source))
+    {
+        std::cerr << "ファイルを開けませんでした: " << objPath << std::endl;
+        return mesh;
+    }
+    std::uint64_t hash = hashBytes(FNV_OFFSET, source.data(), source.size());
+    hash = hashBytes(hash, &CACHE_VERSION, sizeof(CACHE_VERSION));
+    std::string baked = cachePath(objPath, hash, ".mesh");
+
+    std::vector<char> data;
+    if (readWholeFile(baked, data))
+    {
+        std::size_t pos = 4;
+        std::uint32_t version, count;
+        Color color;
+        if (data.size() >= 4 && std::memcmp(data.data(), MESH_MAGIC, 4) == 0 &&
+            take(data, pos, version) && version == CACHE_VERSION && take(data, pos, count) && take(data, pos, color) &&
+            pos + static_cast<std::size_t>(count) * 8 * sizeof(float) == data.size())
+        {
+            mesh.vertexCount = static_cast<int>(count);
+            mesh.triangleCount = static_cast<int>(count / 3);
+            mesh.vertices = takeArray<float>(data, pos, count * 3);
+            mesh.texcoords = takeArray<float>(data, pos, count * 2);
+            mesh.normals = takeArray<float>(data, pos, count * 3);
+            if (diffuse) *diffuse = color;
+            return mesh;
+        }
+    }
+
+    ObjMesh obj;
+    if (!parseObj(objPath, source, obj))
+    {
+        std::cerr << "モデルを読み込めませんでした: " << objPath << std::endl;
+        return mesh;
+    }
+
+    std::uint32_t count = static_cast<std::uint32_t>(obj.vertices.size() / 3);
+    std::vector<char> out(MESH_MAGIC, MESH_MAGIC + 4);
+    append(out, CACHE_VERSION);
+    append(out, count);
+    append(out, obj.diffuse);
+    appendArray(out, obj.vertices.data(), obj.vertices.size() * sizeof(float));
+    appendArray(out, obj.texcoords.data(), obj.texcoords.size() * sizeof(float));
+    appendArray(out, obj.normals.data(), obj.normals.size() * sizeof(float));
+    writeWholeFile(baked, out);
+
+    std::size_t pos = out.size() - static_cast<std::size_t>(count) * 8 * sizeof(float);
+    mesh.vertexCount = static_cast<int>(count);
+    mesh.triangleCount = static_cast<int>(count / 3);
+    mesh.vertices = takeArray<float>(out, pos, count * 3);
+    mesh.texcoords = takeArray<float>(out, pos, count * 2);
+    mesh.normals = takeArray<float>(out, pos, count * 3);
+    if (diffuse) *diffuse = obj.diffuse;
+    return mesh;
+}
+
+// =====================================================================
+// AssetLoader
+
+AssetLoader::AssetLoader(int threadCount)
+{
+    for (int i = 0; i < threadCount; i++) threads.emplace_back(&AssetLoader::worker, this);
+}
+
+AssetLoader::~AssetLoader()
+{
+    stop();
+}
+
+void AssetLoader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) thread.join();
+    threads.clear();
+}
+
+void AssetLoader::run(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+        unfinished++;
+    }
+    wake.notify_one();
+}
+
+void AssetLoader::poll()
+{
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(finished);
+    }
+    for (std::function<void()>& fn : ready)
+    {
+        if (fn) fn();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    unfinished -= static_cast<int>(ready.size());
+}
+
+int AssetLoader::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return unfinished;
+}
+
+void AssetLoader::worker()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        wake.wait(lock, [this] { return quit || !jobs.empty(); });
+        if (quit) break;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        std::function<void()> then;
+        {
+            PROFILE_SCOPE("asset load");
+            then = job();
+        }
+        lock.lock();
+        finished.push_back(std::move(then));
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 元ファイルの中身のハッシュをキーにして、変換済みのデータを cache/ に置く
+//   *.img  リサイズ済みの RGBA8 の画素
+//   *.mesh OBJ を展開した頂点 (三角形ごと) と拡散色
+// 2 回目以降は PNG のデコードや OBJ の解析をせずにそのまま読む
+class AssetCache {
+public:
+    explicit AssetCache(std::string directory = "cache");
+
+    // width, height が 0 ならリサイズしない。失敗したら data が NULL の Image
+    Image loadImage(const std::string& path, int width = 0, int height = 0) const;
+    // GPU には送っていない Mesh (UploadMesh はメインスレッドで)。失敗したら vertexCount が 0
+    Mesh loadMesh(const std::string& objPath, Color* diffuse = nullptr) const;
+
+private:
+    std::string cachePath(const std::string& source, std::uint64_t hash, const char* extension) const;
+
+    std::string directory;
+};
+
+// ファイルの中身の FNV-1a ハッシュ。読めなければ false
+bool hashFile(const std::string& path, std::uint64_t& hash);
+
+// ワーカースレッドで読み込み、続き (GPU への転送など) をメインスレッドで実行する
+class AssetLoader {
+public:
+    // ワーカースレッドで実行し、メインスレッドで呼ぶ続きを返す
+    using Job = std::function<std::function<void()>()>;
+
+    explicit AssetLoader(int threadCount = 2);
+    ~AssetLoader(); // stop と同じ
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    void run(Job job);
+    // まだ始まっていないジョブを捨てて、実行中のものが終わるまで待つ (続きは呼ばない)
+    // ジョブが参照しているものを壊す前に呼ぶ
+    void stop();
+
+    // 終わったジョブの続きをメインスレッドで実行する。毎フレーム呼ぶ
+    void poll();
+    // 実行中・続き待ちのジョブ数
+    int pending() const;
+
+private:
+    void worker();
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::vector<std::function<void()>> finished;
+    int unfinished = 0;
+    bool quit = false;
+    std::vector<std::thread> threads;
+};
@@ -0,0 +1,254 @@
+#include "audio.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "profiler.hpp"
+
+namespace {
+
+// コールバックに引数が渡せないので、鳴らしているものを覚えておく
+std::atomic<AudioSystem*> activeSystem{ nullptr };
+
+constexpr auto MUSIC_UPDATE_INTERVAL = std::chrono::milliseconds(5);
+
+} // namespace
+
+AudioSystem::~AudioSystem()
+{
+    stop();
+}
+
+void AudioSystem::start()
+{
+    if (started) return;
+    started = true;
+
+    mixStream = LoadAudioStream(MIX_RATE, 32, 2);
+    activeSystem.store(this);
+    SetAudioStreamCallback(mixStream, &AudioSystem::mixCallback);
+    PlayAudioStream(mixStream);
+
+    quit = false;
+    thread = std::thread(&AudioSystem::musicThread, this);
+}
+
+void AudioSystem::stop()
+{
+    if (!started) return;
+    started = false;
+
+    {
+        std::lock_guard<std::mutex> lock(musicMutex);
+        quit = true;
+    }
+    musicWake.notify_all();
+    if (thread.joinable()) thread.join();
+
+    StopAudioStream(mixStream);
+    UnloadAudioStream(mixStream);
+    activeSystem.store(nullptr);
+}
+
+AudioSystem::ClipId AudioSystem::loadClip(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(clipsMutex);
+        auto it = clipIds.find(path);
+        if (it != clipIds.end()) return it->second;
+    }
+
+    // デコードはロックの外で
+    Wave wave = LoadWave(path.c_str());
+    if (!IsWaveValid(wave))
+    {
+        std::cerr << "音声を読み込めませんでした: " << path << std::endl;
+        return NO_CLIP;
+    }
+    WaveFormat(&wave, MIX_RATE, wave.sampleSize, 2);
+    auto clip = std::make_unique<Clip>();
+    clip->frames = wave.frameCount;
+    float* samples = LoadWaveSamples(wave);
+    clip->samples.assign(samples, samples + static_cast<std::size_t>(wave.frameCount) * 2);
+    UnloadWaveSamples(samples);
+    UnloadWave(wave);
+
+    std::lock_guard<std::mutex> lock(clipsMutex);
+    auto it = clipIds.find(path);
+    if (it != clipIds.end()) return it->second; // 別のスレッドが先に読んだ
+    ClipId id = static_cast<ClipId>(clips.size());
+    clips.push_back(std::move(clip));
+    clipIds.emplace(path, id);
+    return id;
+}
+
+void AudioSystem::play(ClipId clip, float volume, float pitch)
+{
+    if (clip == NO_CLIP || !started) return;
+    const Clip* data;
+    {
+        std::lock_guard<std::mutex> lock(clipsMutex);
+        if (clip < 0 || clip >= static_cast<ClipId>(clips.size())) return;
+        data = clips[clip].get();
+    }
+    if (data->frames < 2) return;
+
+    std::uint32_t head = commandHead.load(std::memory_order_relaxed);
+    std::uint32_t tail = commandTail.load(std::memory_order_acquire);
+    if (head - tail >= COMMAND_CAPACITY) return; // 要求が多すぎるときは捨てる
+    commands[head % COMMAND_CAPACITY] = { data, volume, std::max(pitch, 0.01f) };
+    commandHead.store(head + 1, std::memory_order_release);
+}
+
+void AudioSystem::playMusic(const std::string& path, float volume)
+{
+    {
+        std::lock_guard<std::mutex> lock(musicMutex);
+        musicPath = path;
+        musicVolume = volume;
+        musicRequest++;
+    }
+    musicWake.notify_all();
+}
+
+void AudioSystem::setEnabled(bool enable)
+{
+    masterVolume.store(enable ? 1.0f : 0.0f);
+    {
+        std::lock_guard<std::mutex> lock(musicMutex);
+        enabled = enable;
+    }
+    musicWake.notify_all();
+}
+
+void AudioSystem::mixCallback(void* buffer, unsigned int frames)
+{
+    float* out = static_cast<float*>(buffer);
+    AudioSystem* system = activeSystem.load();
+    if (system) system->mix(out, frames);
+    else std::memset(out, 0, frames * 2 * sizeof(float));
+}
+
+void AudioSystem::startVoice(const PlayCommand& command)
+{
+    // 空いているボイス、無ければ一番終わりに近いもの
+    Voice* target = nullptr;
+    double furthest = -1.0;
+    for (Voice& voice : voices)
+    {
+        if (!voice.clip)
+        {
+            target = &voice;
+            break;
+        }
+        double progress = voice.position / voice.clip->frames;
+        if (progress > furthest)
+        {
+            furthest = progress;
+            target = &voice;
+        }
+    }
+    target->clip = command.clip;
+    target->position = 0.0;
+    target->volume = command.volume;
+    target->pitch = command.pitch;
+}
+
+void AudioSystem::mix(float* out, unsigned int frames)
+{
+    // 溜まっている再生要求を取り出す
+    std::uint32_t head = commandHead.load(std::memory_order_acquire);
+    std::uint32_t tail = commandTail.load(std::memory_order_relaxed);
+    for (; tail != head; tail++) startVoice(commands[tail % COMMAND_CAPACITY]);
+    commandTail.store(tail, std::memory_order_release);
+
+    std::memset(out, 0, frames * 2 * sizeof(float));
+    const float master = masterVolume.load(std::memory_order_relaxed);
+    for (Voice& voice : voices)
+    {
+        if (!voice.clip) continue;
+        const Clip& clip = *voice.clip;
+        const float* pcm = clip.samples.data();
+        const float gain = voice.volume * master;
+        unsigned int i = 0;
+        for (; i < frames; i++)
+        {
+            // pitch が 1 以外なら隣のフレームと線形補間
+            std::uint32_t frame = static_cast<std::uint32_t>(voice.position);
+            if (frame + 1 >= clip.frames) break;
+            float t = static_cast<float>(voice.position - frame);
+            const float* a = pcm + frame * 2;
+            out[i * 2] += (a[0] + (a[2] - a[0]) * t) * gain;
+            out[i * 2 + 1] += (a[1] + (a[3] - a[1]) * t) * gain;
+            voice.position += voice.pitch;
+        }
+        if (i < frames) voice.clip = nullptr; // 最後まで鳴らした
+    }
+    for (unsigned int i = 0; i < frames * 2; i++) out[i] = std::clamp(out[i], -1.0f, 1.0f);
+}
+
+void AudioSystem::musicThread()
+{
+    Music music{};
+    bool loaded = false;
+    bool playing = false;
+    bool begun = false; // 一度でも再生したか (2 回目からは続きから)
+    std::uint32_t loadedRequest = 0;
+
+    std::unique_lock<std::mutex> lock(musicMutex);
+    while (!quit)
+    {
+        if (musicRequest != loadedRequest)
+        {
+            // 差し替え。ファイルを開くのもここで (メインスレッドを待たせない)
+            loadedRequest = musicRequest;
+            std::string path = musicPath;
+            float volume = musicVolume;
+            lock.unlock();
+            if (loaded) UnloadMusicStream(music);
+            music = LoadMusicStream(path.c_str());
+            loaded = IsMusicValid(music);
+            playing = false;
+            begun = false;
+            if (loaded)
+            {
+                music.looping = true;
+                SetMusicVolume(music, volume);
+            }
+            else
+            {
+                std::cerr << "BGM を読み込めませんでした: " << path << std::endl;
+            }
+            lock.lock();
+        }
+
+        if (loaded && enabled != playing)
+        {
+            playing = enabled;
+            if (playing && !begun) PlayMusicStream(music);
+            else if (playing) ResumeMusicStream(music);
+            else if (begun) PauseMusicStream(music);
+            if (playing) begun = true;
+        }
+
+        if (loaded && playing)
+        {
+            lock.unlock();
+            {
+                PROFILE_SCOPE("music");
+                UpdateMusicStream(music);
+            }
+            lock.lock();
+        }
+        musicWake.wait_for(lock, MUSIC_UPDATE_INTERVAL);
+    }
+    lock.unlock();
+
+    if (loaded)
+    {
+        StopMusicStream(music);
+        UnloadMusicStream(music);
+    }
+}
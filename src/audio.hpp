@@ -0,0 +1,102 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 効果音とBGM
+//   効果音: 短いファイルは最初に 1 回だけデコードして PCM のまま持っておき、
+//           あらかじめ用意した数のボイスで自前で混ぜる (鳴らすときにメモリを確保しない)
+//   BGM:    ストリームの読み込みとデコードは専用の音声スレッドで回す (描画が遅れても途切れない)
+// InitAudioDevice の後に start、CloseAudioDevice の前に stop を呼ぶ
+class AudioSystem {
+public:
+    using ClipId = int;
+    static constexpr ClipId NO_CLIP = -1;
+
+    static constexpr int MIX_RATE = 44100;
+    static constexpr int MAX_VOICES = 32;          // 同時に鳴らせる効果音の数 (超えたら一番進んでいるものを止める)
+    static constexpr int COMMAND_CAPACITY = 256;   // 1 回のミックスまでに溜められる再生要求 (超えたら捨てる)
+
+    AudioSystem() = default;
+    ~AudioSystem();
+
+    AudioSystem(const AudioSystem&) = delete;
+    AudioSystem& operator=(const AudioSystem&) = delete;
+
+    void start();
+    void stop();
+
+    // ファイルをデコードしてキャッシュする (同じパスは 1 回だけ)。どのスレッドからでもよい
+    ClipId loadClip(const std::string& path);
+    // メインスレッドから。pitch は 1 で元の速さ
+    void play(ClipId clip, float volume = 1.0f, float pitch = 1.0f);
+
+    // BGM を差し替える (ループ再生)。読み込みは音声スレッドで
+    void playMusic(const std::string& path, float volume = 1.0f);
+    // false にすると BGM も効果音も止める
+    void setEnabled(bool enabled);
+
+private:
+    // ステレオ float、MIX_RATE に揃えた PCM
+    struct Clip {
+        std::vector<float> samples;
+        std::uint32_t frames = 0;
+    };
+
+    struct PlayCommand {
+        const Clip* clip;
+        float volume;
+        float pitch;
+    };
+
+    struct Voice {
+        const Clip* clip = nullptr;
+        double position = 0.0; // フレーム単位
+        float volume = 1.0f;
+        float pitch = 1.0f;
+    };
+
+    // miniaudio のスレッドから呼ばれる
+    static void mixCallback(void* buffer, unsigned int frames);
+    void mix(float* out, unsigned int frames);
+    void startVoice(const PlayCommand& command);
+
+    void musicThread();
+
+    // クリップは消さないので、ポインタは stop までずっと有効
+    std::mutex clipsMutex;
+    std::vector<std::unique_ptr<Clip>> clips;
+    std::unordered_map<std::string, ClipId> clipIds;
+
+    // メインスレッドが書いて、ミックスのスレッドが読むリングバッファ
+    std::array<PlayCommand, COMMAND_CAPACITY> commands{};
+    std::atomic<std::uint32_t> commandHead{ 0 };
+    std::atomic<std::uint32_t> commandTail{ 0 };
+
+    // ミックスのスレッドだけが触る
+    std::array<Voice, MAX_VOICES> voices{};
+
+    std::atomic<float> masterVolume{ 1.0f };
+    AudioStream mixStream{};
+    bool started = false;
+
+    // BGM (音声スレッド)
+    std::mutex musicMutex;
+    std::condition_variable musicWake;
+    std::string musicPath;
+    std::uint32_t musicRequest = 0; // 差し替えのたびに増える
+    float musicVolume = 1.0f;
+    bool enabled = true;
+    bool quit = false;
+    std::thread thread;
+};
@@ -0,0 +1,68 @@
+#include "blockatlas.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// 色に少しざらつきを足しただけのタイル
+Image makeFallbackTile(const BlockTexture& texture, int seed)
+{
+    Color base = { texture.color[0], texture.color[1], texture.color[2], 255 };
+    Image image = GenImageColor(AtlasLayout::TILE_PIXELS, AtlasLayout::TILE_PIXELS, base);
+    Color* pixels = static_cast<Color*>(image.data);
+    for (int y = 0; y < image.height; y++)
+    for (int x = 0; x < image.width; x++)
+    {
+        // 符号なしで掛ける (int のままだとあふれて未定義になる)
+        std::uint32_t h = static_cast<std::uint32_t>(x) * 73856093u ^ static_cast<std::uint32_t>(y) * 19349663u ^
+                          static_cast<std::uint32_t>(seed) * 83492791u;
+        h ^= h >> 13;
+        h *= 0x5bd1e995u;
+        h ^= h >> 15;
+        float scale = 0.88f + 0.24f * ((h & 0xff) / 255.0f);
+        Color& p = pixels[x + y * image.width];
+        p.r = static_cast<unsigned char>(std::fmin(255.0f, base.r * scale));
+        p.g = static_cast<unsigned char>(std::fmin(255.0f, base.g * scale));
+        p.b = static_cast<unsigned char>(std::fmin(255.0f, base.b * scale));
+    }
+    return image;
+}
+
+} // namespace
+
+Image buildBlockAtlas(const BlockRegistry& registry, const AssetCache& cache, AtlasLayout& layout)
+{
+    const std::vector<BlockTexture>& tiles = registry.tiles();
+    int count = tiles.empty() ? 1 : static_cast<int>(tiles.size());
+    layout.columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    layout.rows = (count + layout.columns - 1) / layout.columns;
+
+    Image atlas = GenImageColor(layout.width(), layout.height(), BLANK);
+    Color* atlasPixels = static_cast<Color*>(atlas.data);
+    const int tileSize = AtlasLayout::TILE_PIXELS;
+    const int padding = AtlasLayout::PADDING;
+
+    for (int i = 0; i < static_cast<int>(tiles.size()); i++)
+    {
+        Image tile{};
+        if (FileExists(tiles[i].path.c_str())) tile = cache.loadImage(tiles[i].path, tileSize, tileSize);
+        if (tile.data == nullptr) tile = makeFallbackTile(tiles[i], i);
+        const Color* tilePixels = static_cast<const Color*>(tile.data);
+
+        // 余白には反対側の端を続けて置く (面の中で繰り返したときと同じ見た目)
+        int cellX = (i % layout.columns) * AtlasLayout::CELL_PIXELS;
+        int cellY = (i / layout.columns) * AtlasLayout::CELL_PIXELS;
+        for (int y = 0; y < AtlasLayout::CELL_PIXELS; y++)
+        for (int x = 0; x < AtlasLayout::CELL_PIXELS; x++)
+        {
+            int sx = (x - padding + tileSize) % tileSize;
+            int sy = (y - padding + tileSize) % tileSize;
+            atlasPixels[(cellX + x) + (cellY + y) * atlas.width] = tilePixels[sx + sy * tileSize];
+        }
+        UnloadImage(tile);
+    }
+
+    ImageMipmaps(&atlas);
+    return atlas;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <raylib.h>
+
+#include "assetcache.hpp"
+#include "blocks.hpp"
+
+// ブロックのテクスチャを 1 枚にまとめたアトラスの並び方
+// タイルの周りには同じタイルを繰り返した画素を padding ぶん足してあるので、
+// log2(padding) までのミップレベルなら隣のタイルがにじまない
+struct AtlasLayout {
+    static constexpr int TILE_PIXELS = 64;
+    static constexpr int PADDING = 8;
+    static constexpr int CELL_PIXELS = TILE_PIXELS + 2 * PADDING;
+    static constexpr float MAX_LOD = 3.0f; // log2(PADDING)
+
+    int columns = 1;
+    int rows = 1;
+    int width() const { return columns * CELL_PIXELS; }
+    int height() const { return rows * CELL_PIXELS; }
+};
+
+// registry のタイルを全部並べたミップマップ付きの画像 (GPU には送っていない)
+// 画像ファイルが無いタイルは BlockTexture の色から作る
+Image buildBlockAtlas(const BlockRegistry& registry, const AssetCache& cache, AtlasLayout& layout);
@@ -0,0 +1,59 @@
+#include "blocks.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const char* const DIRT_TEXTURE = "resources/Dart_Block_Textures/Dart.png";
+
+// 番号の順に並べる (0 は空気)
+const BlockType BLOCK_TABLE[] = {
+    { "air", 0, {}, {} },
+    { "stone", BLOCK_FLAG_SOLID | BLOCK_FLAG_OPAQUE,
+      { { "resources/Stone_Block_Textures/Stone.png", { 130, 130, 130 } },
+        { "resources/Stone_Block_Textures/Stone.png", { 130, 130, 130 } },
+        { "resources/Stone_Block_Textures/Stone.png", { 130, 130, 130 } } }, {} },
+    { "dirt", BLOCK_FLAG_SOLID | BLOCK_FLAG_OPAQUE,
+      { { DIRT_TEXTURE, { 134, 96, 67 } },
+        { DIRT_TEXTURE, { 134, 96, 67 } },
+        { DIRT_TEXTURE, { 134, 96, 67 } } }, {} },
+    { "grass", BLOCK_FLAG_SOLID | BLOCK_FLAG_OPAQUE,
+      { { "resources/Grass_Block_Textures/GrassTop.png", { 95, 159, 53 } },
+        { "resources/Grass_Block_Textures/GrassSide.png", { 112, 128, 60 } },
+        { DIRT_TEXTURE, { 134, 96, 67 } } }, {} },
+    { "sand", BLOCK_FLAG_SOLID | BLOCK_FLAG_OPAQUE,
+      { { "resources/Sand_Block_Textures/Sand.png", { 219, 211, 160 } },
+        { "resources/Sand_Block_Textures/Sand.png", { 219, 211, 160 } },
+        { "resources/Sand_Block_Textures/Sand.png", { 219, 211, 160 } } }, {} },
+};
+
+} // namespace
+
+const BlockRegistry& blockRegistry()
+{
+    static BlockRegistry instance;
+    return instance;
+}
+
+BlockRegistry::BlockRegistry() : types(std::begin(BLOCK_TABLE), std::end(BLOCK_TABLE))
+{
+    // 同じテクスチャは同じタイルを使う
+    for (std::size_t id = 0; id < types.size(); id++)
+    {
+        BlockType& type = types[id];
+        for (int face = 0; face < FACE_COUNT; face++)
+        {
+            type.tiles[face] = 0;
+            if (id == BLOCK_AIR) continue;
+            const BlockTexture& texture = type.textures[face];
+            auto it = std::find(tileTextures.begin(), tileTextures.end(), texture);
+            type.tiles[face] = static_cast<int>(it - tileTextures.begin());
+            if (it == tileTextures.end()) tileTextures.push_back(texture);
+        }
+    }
+}
+
+const BlockType& BlockRegistry::get(BlockId id) const
+{
+    return id < types.size() ? types[id] : types[BLOCK_STONE];
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "world.hpp"
+
+// ブロックの種類の番号 (セーブファイルにもこの番号で入る)
+constexpr BlockId BLOCK_STONE = 1;
+constexpr BlockId BLOCK_DIRT = 2;
+constexpr BlockId BLOCK_GRASS = 3;
+constexpr BlockId BLOCK_SAND = 4;
+
+// ブロックの性質
+enum BlockFlags : std::uint8_t {
+    BLOCK_FLAG_SOLID = 1 << 0,  // ぶつかる
+    BLOCK_FLAG_OPAQUE = 1 << 1, // 向こうが見えない (接している面を描かない)
+};
+
+// 面の向き
+enum BlockFace {
+    FACE_TOP = 0,
+    FACE_SIDE = 1,
+    FACE_BOTTOM = 2,
+    FACE_COUNT = 3,
+};
+
+// 1 枚のテクスチャ。path の画像が無ければ color から作る
+struct BlockTexture {
+    std::string path;
+    std::uint8_t color[3];
+
+    bool operator==(const BlockTexture& other) const
+    {
+        return path == other.path && color[0] == other.color[0] && color[1] == other.color[1] &&
+               color[2] == other.color[2];
+    }
+};
+
+struct BlockType {
+    std::string name;
+    std::uint8_t flags;
+    BlockTexture textures[FACE_COUNT]; // 上・横・下
+    int tiles[FACE_COUNT];             // アトラスの中のタイル番号 (BlockRegistry が決める)
+};
+
+// ブロックの種類の一覧。新しいブロックは blocks.cpp の表に 1 行足すだけ
+// 起動時に作ったら変わらないので、どのスレッドから読んでもよい
+class BlockRegistry {
+public:
+    BlockRegistry();
+
+    // 登録されていない番号は石として扱う
+    const BlockType& get(BlockId id) const;
+    int typeCount() const { return static_cast<int>(types.size()); }
+
+    int tileOf(BlockId id, BlockFace face) const { return get(id).tiles[face]; }
+    bool isOpaque(BlockId id) const { return id != BLOCK_AIR && (get(id).flags & BLOCK_FLAG_OPAQUE); }
+    bool isSolid(BlockId id) const { return id != BLOCK_AIR && (get(id).flags & BLOCK_FLAG_SOLID); }
+
+    // 重複を除いたテクスチャ (番号がタイル番号)
+    const std::vector<BlockTexture>& tiles() const { return tileTextures; }
+
+private:
+    std::vector<BlockType> types;
+    std::vector<BlockTexture> tileTextures;
+};
+
+const BlockRegistry& blockRegistry();
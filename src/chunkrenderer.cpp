@@ -0,0 +1,179 @@
+#include "chunkrenderer.hpp"
+
+#include <raymath.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+template <typename T>
+T* copyToRaylib(const std::vector<T>& src)
+{
+    // UnloadMesh が RL_FREE で解放するので MemAlloc で確保する
+    T* dst = static_cast<T*>(MemAlloc(static_cast<unsigned int>(src.size() * sizeof(T))));
+    std::memcpy(dst, src.data(), src.size() * sizeof(T));
+    return dst;
+}
+
+} // namespace
+
+void ChunkRenderer::load(const AssetCache& cache, AssetLoader& loader)
+{
+    // タイルの読み込みと縮小版作りは重いのでワーカーで
+    loader.run([this, &cache]() -> std::function<void()> {
+        AtlasLayout layout;
+        Image atlasImage = buildBlockAtlas(blockRegistry(), cache, layout);
+        return [this, atlasImage, layout]() { createMaterial(atlasImage, layout); };
+    });
+}
+
+void ChunkRenderer::createMaterial(Image atlasImage, const AtlasLayout& layout)
+{
+    // 全部のブロックを 1 枚のアトラスと 1 つのシェーダーで描く (種類が増えても描画回数は同じ)
+    Texture2D atlas = LoadTextureFromImage(atlasImage);
+    UnloadImage(atlasImage);
+    SetTextureFilter(atlas, TEXTURE_FILTER_TRILINEAR);
+    SetTextureWrap(atlas, TEXTURE_WRAP_CLAMP);
+
+    Shader shader = LoadShader("resources/shaders/chunk.vs", "resources/shaders/chunk.fs");
+    float atlasLayout[4] = { static_cast<float>(layout.columns), static_cast<float>(AtlasLayout::TILE_PIXELS),
+                             static_cast<float>(AtlasLayout::PADDING), AtlasLayout::MAX_LOD };
+    float atlasSize[2] = { static_cast<float>(layout.width()), static_cast<float>(layout.height()) };
+    SetShaderValue(shader, GetShaderLocation(shader, "atlasLayout"), atlasLayout, SHADER_UNIFORM_VEC4);
+    SetShaderValue(shader, GetShaderLocation(shader, "atlasSize"), atlasSize, SHADER_UNIFORM_VEC2);
+
+    material = LoadMaterialDefault();
+    material.shader = shader;
+    material.maps[MATERIAL_MAP_DIFFUSE].texture = atlas;
+    materialLoaded = true;
+}
+
+void ChunkRenderer::unload()
+{
+    for (auto& entry : meshes)
+    {
+        if (entry.second.cancel) entry.second.cancel->store(true);
+        release(entry.second);
+    }
+    meshes.clear();
+    if (materialLoaded) UnloadMaterial(material); // アトラスとシェーダーも一緒に解放される
+    materialLoaded = false;
+}
+
+void ChunkRenderer::update(const World& world, JobSystem& jobs, Vector3 eye, int maxRequests)
+{
+    // ワールドから消えたチャンクの Mesh を捨てる (作っている途中なら取り消す)
+    for (auto it = meshes.begin(); it != meshes.end();)
+    {
+        if (!world.findLoadedChunk(it->first))
+        {
+            if (it->second.cancel) it->second.cancel->store(true);
+            release(it->second);
+            it = meshes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // 作り直しが必要なチャンクを近い順に選ぶ
+    struct Candidate {
+        ChunkCoord coord;
+        float distance;
+        std::uint32_t revision;
+    };
+    std::vector<Candidate> candidates;
+    const float half = CHUNK_SIZE * 0.5f;
+    for (const auto& entry : world.allChunks())
+    {
+        const Chunk& chunk = *entry.second;
+        auto it = meshes.find(entry.first);
+        if (it != meshes.end() && (it->second.meshing || it->second.revision == chunk.meshRevision)) continue;
+
+        const ChunkCoord& c = entry.first;
+        Vector3 center = { c.x * CHUNK_SIZE + half, c.y * CHUNK_SIZE + half, c.z * CHUNK_SIZE + half };
+        candidates.push_back({ c, Vector3Distance(center, eye), chunk.meshRevision });
+    }
+    auto nearer = [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; };
+    if (static_cast<int>(candidates.size()) > maxRequests)
+    {
+        std::partial_sort(candidates.begin(), candidates.begin() + maxRequests, candidates.end(), nearer);
+        candidates.resize(maxRequests);
+    }
+
+    for (const Candidate& candidate : candidates)
+    {
+        // 周りのブロックはここで写しておく (ワーカーはワールドに触らない)
+        auto padded = std::make_shared<PaddedChunk>();
+        gatherPaddedChunk(world, candidate.coord, *padded);
+
+        ChunkMesh& entry = meshes[candidate.coord];
+        entry.meshing = true;
+        entry.meshingRevision = candidate.revision;
+        entry.cancel = JobSystem::makeCancelToken();
+
+        ChunkCoord coord = candidate.coord;
+        jobs.run("mesh", candidate.distance, [this, coord, padded]() -> std::function<void()> {
+            auto data = std::make_shared<ChunkMeshData>();
+            greedyMesh(*padded, *data);
+            return [this, coord, data]() {
+                auto it = meshes.find(coord);
+                if (it == meshes.end()) return;
+                ChunkMesh& entry = it->second;
+                entry.meshing = false;
+                entry.revision = entry.meshingRevision; // 途中で変わっていたら次の update でもう一度
+                upload(entry, *data);
+            };
+        }, entry.cancel);
+    }
+}
+
+void ChunkRenderer::upload(ChunkMesh& entry, const ChunkMeshData& data)
+{
+    release(entry);
+    if (data.indices.empty()) return; // 空気だけ、または全部埋まっている
+
+    Mesh mesh{};
+    mesh.vertexCount = data.vertexCount();
+    mesh.triangleCount = data.triangleCount();
+    mesh.vertices = copyToRaylib(data.vertices);
+    mesh.normals = copyToRaylib(data.normals);
+    mesh.texcoords = copyToRaylib(data.texcoords);
+    mesh.texcoords2 = copyToRaylib(data.tiles);
+    mesh.colors = copyToRaylib(data.colors);
+    mesh.indices = copyToRaylib(data.indices);
+    UploadMesh(&mesh, false);
+
+    entry.mesh = mesh;
+    entry.uploaded = true;
+}
+
+void ChunkRenderer::release(ChunkMesh& entry)
+{
+    if (entry.uploaded) UnloadMesh(entry.mesh);
+    entry.mesh = Mesh{};
+    entry.uploaded = false;
+}
+
+void ChunkRenderer::draw(const Frustum& frustum, CullStats& stats)
+{
+    lastDrawCalls = 0;
+    lastTriangles = 0;
+    if (!materialLoaded) return;
+    const float size = static_cast<float>(CHUNK_SIZE);
+    for (const auto& entry : meshes)
+    {
+        if (!entry.second.uploaded) continue;
+        const ChunkCoord& c = entry.first;
+        Vector3 origin = { c.x * size, c.y * size, c.z * size };
+        BoundingBox bounds = { origin, { origin.x + size, origin.y + size, origin.z + size } };
+        if (!stats.test(frustum, bounds)) continue;
+
+        DrawMesh(entry.second.mesh, material, MatrixTranslate(origin.x, origin.y, origin.z));
+        lastDrawCalls++;
+        lastTriangles += entry.second.mesh.triangleCount;
+    }
+}
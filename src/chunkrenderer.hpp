@@ -0,0 +1,61 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+#include "assetcache.hpp"
+#include "blockatlas.hpp"
+#include "culling.hpp"
+#include "jobsystem.hpp"
+#include "mesher.hpp"
+#include "world.hpp"
+
+// チャンクごとに 1 つの Mesh を持って描画する
+class ChunkRenderer {
+public:
+    ChunkRenderer() = default;
+
+    ChunkRenderer(const ChunkRenderer&) = delete;
+    ChunkRenderer& operator=(const ChunkRenderer&) = delete;
+
+    // ブロックのアトラスを loader のワーカーで作り、続きで GPU に送ってシェーダーを読む
+    // それまでは draw で何も描かない (メッシュ生成は先に進める)。loader はこれより先に止める
+    void load(const AssetCache& cache, AssetLoader& loader);
+
+    // 変更のあったチャンクのメッシュ生成を jobs に頼む (1 フレームに maxRequests 個まで、eye に近い順)
+    // できたものは jobs.poll の中で GPU に送る
+    void update(const World& world, JobSystem& jobs, Vector3 eye, int maxRequests = 64);
+    // BeginMode3D の中で呼ぶ。視錐台の外のチャンクは描かない
+    void draw(const Frustum& frustum, CullStats& stats);
+    // CloseWindow の前に呼ぶ
+    void unload();
+
+    // 直前の draw で描いた数
+    int drawCalls() const { return lastDrawCalls; }
+    int drawnTriangles() const { return lastTriangles; }
+
+private:
+    struct ChunkMesh {
+        Mesh mesh{};
+        bool uploaded = false;
+        std::uint32_t revision = 0;
+        // 作っている最中のメッシュ
+        bool meshing = false;
+        std::uint32_t meshingRevision = 0;
+        JobSystem::CancelToken cancel;
+    };
+
+    void upload(ChunkMesh& entry, const ChunkMeshData& data);
+    static void release(ChunkMesh& entry);
+
+    std::unordered_map<ChunkCoord, ChunkMesh, ChunkCoordHash> meshes;
+    void createMaterial(Image atlasImage, const AtlasLayout& layout);
+
+    Material material{};
+    bool materialLoaded = false;
+    int lastDrawCalls = 0;
+    int lastTriangles = 0;
+};
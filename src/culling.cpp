@@ -0,0 +1,82 @@
+#include "culling.hpp"
+
+#include <raymath.h>
+
+#include <cmath>
+
+namespace {
+
+// raylib の rlgl と同じ近クリップ面 (RL_CULL_DISTANCE_NEAR)
+constexpr float NEAR_PLANE = 0.01f;
+
+void setPlane(Frustum& f, int i, Vector3 normal, Vector3 point)
+{
+    f.normals[i] = normal;
+    f.distances[i] = -Vector3DotProduct(normal, point);
+}
+
+} // namespace
+
+Frustum makeFrustum(const Camera3D& camera, float aspect, float viewDistance)
+{
+    Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+    Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+    Vector3 up = Vector3CrossProduct(right, forward);
+
+    float halfV = camera.fovy * 0.5f * DEG2RAD;
+    float halfH = atanf(tanf(halfV) * aspect);
+
+    Frustum f;
+    f.position = camera.position;
+    f.viewDistance = viewDistance;
+
+    // 側面は、画面の端を通る方向に垂直で内側を向く法線を持つ
+    Vector3 fh = Vector3Scale(forward, sinf(halfH));
+    Vector3 fv = Vector3Scale(forward, sinf(halfV));
+    Vector3 rh = Vector3Scale(right, cosf(halfH));
+    Vector3 uv = Vector3Scale(up, cosf(halfV));
+    setPlane(f, 0, Vector3Add(fh, rh), camera.position);      // 左
+    setPlane(f, 1, Vector3Subtract(fh, rh), camera.position); // 右
+    setPlane(f, 2, Vector3Add(fv, uv), camera.position);      // 下
+    setPlane(f, 3, Vector3Subtract(fv, uv), camera.position); // 上
+    setPlane(f, 4, forward, Vector3Add(camera.position, Vector3Scale(forward, NEAR_PLANE)));
+    setPlane(f, 5, Vector3Negate(forward), Vector3Add(camera.position, Vector3Scale(forward, viewDistance)));
+    return f;
+}
+
+bool isBoxVisible(const Frustum& frustum, const BoundingBox& box)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        // 法線の方向にいちばん出ている角が外側なら、箱は全部外側
+        const Vector3& n = frustum.normals[i];
+        Vector3 p = {
+            n.x >= 0.0f ? box.max.x : box.min.x,
+            n.y >= 0.0f ? box.max.y : box.min.y,
+            n.z >= 0.0f ? box.max.z : box.min.z,
+        };
+        if (Vector3DotProduct(n, p) + frustum.distances[i] < 0.0f) return false;
+    }
+
+    // 遠平面だけだと画面の端のほうが遠くまで見えるので、球でも切る
+    Vector3 closest = {
+        Clamp(frustum.position.x, box.min.x, box.max.x),
+        Clamp(frustum.position.y, box.min.y, box.max.y),
+        Clamp(frustum.position.z, box.min.z, box.max.z),
+    };
+    return Vector3DistanceSqr(closest, frustum.position) <= frustum.viewDistance * frustum.viewDistance;
+}
+
+BoundingBox placeBox(const BoundingBox& box, Vector3 position, float scale)
+{
+    return {
+        Vector3Add(Vector3Scale(box.min, scale), position),
+        Vector3Add(Vector3Scale(box.max, scale), position),
+    };
+}
+
+BoundingBox cubeBounds(Vector3 position, float width, float height, float length)
+{
+    Vector3 half = { width * 0.5f, height * 0.5f, length * 0.5f };
+    return { Vector3Subtract(position, half), Vector3Add(position, half) };
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <raylib.h>
+
+// 視錐台 (カメラに映る範囲)。平面は内側が正
+struct Frustum {
+    Vector3 normals[6];
+    float distances[6];
+    Vector3 position; // カメラの位置
+    float viewDistance;
+};
+
+// カメラの position, target, up, fovy と画面の縦横比から作る
+// viewDistance より遠いものは見えないことにする
+Frustum makeFrustum(const Camera3D& camera, float aspect, float viewDistance);
+
+// 少しでも視錐台に入っていて、viewDistance 以内なら true
+bool isBoxVisible(const Frustum& frustum, const BoundingBox& box);
+
+// scale 倍して position に置いたときのバウンディングボックス (DrawModel と同じ置き方)
+BoundingBox placeBox(const BoundingBox& box, Vector3 position, float scale);
+
+// DrawCube と同じ引数の箱
+BoundingBox cubeBounds(Vector3 position, float width, float height, float length);
+
+// 描画したもの / 捨てたものの数 (DevelopMode で表示)
+struct CullStats {
+    int drawn = 0;
+    int culled = 0;
+
+    // 見えるなら drawn、見えないなら culled を増やして結果を返す
+    bool test(const Frustum& frustum, const BoundingBox& box)
+    {
+        bool visible = isBoxVisible(frustum, box);
+        if (visible) drawn++;
+        else culled++;
+        return visible;
+    }
+};
@@ -0,0 +1,117 @@
+#include "jobsystem.hpp"
+
+#include <algorithm>
+
+#include "profiler.hpp"
+
+JobSystem::JobSystem(int threadCount)
+{
+    if (threadCount <= 0)
+    {
+        int cores = static_cast<int>(std::thread::hardware_concurrency());
+        threadCount = std::max(1, cores - 1); // メインスレッドの分を空けておく
+    }
+    for (int i = 0; i < threadCount; i++) queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < threadCount; i++) threads.emplace_back(&JobSystem::worker, this, static_cast<std::size_t>(i));
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) thread.join();
+}
+
+bool JobSystem::later(const Entry& a, const Entry& b)
+{
+    if (a.priority != b.priority) return a.priority > b.priority;
+    return a.order > b.order;
+}
+
+void JobSystem::run(const char* name, float priority, Job job, CancelToken cancel)
+{
+    // 入れる先は順番に回す。偏っても空いたワーカーが盗む
+    Queue& queue = *queues[nextQueue.fetch_add(1) % queues.size()];
+    unfinished.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.heap.push_back({ name, priority, nextOrder.fetch_add(1), std::move(job), std::move(cancel) });
+        std::push_heap(queue.heap.begin(), queue.heap.end(), later);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1);
+    }
+    wake.notify_one();
+}
+
+void JobSystem::poll(int maxContinuations)
+{
+    std::vector<Finished> ready;
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        while (!finished.empty() && static_cast<int>(ready.size()) < maxContinuations)
+        {
+            ready.push_back(std::move(finished.front()));
+            finished.pop_front();
+        }
+    }
+    for (Finished& f : ready)
+    {
+        if (f.then && !cancelled(f.cancel)) f.then();
+    }
+    unfinished.fetch_sub(static_cast<int>(ready.size()));
+}
+
+bool JobSystem::popFrom(Queue& queue, Entry& out)
+{
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.heap.empty()) return false;
+    std::pop_heap(queue.heap.begin(), queue.heap.end(), later);
+    out = std::move(queue.heap.back());
+    queue.heap.pop_back();
+    return true;
+}
+
+bool JobSystem::take(std::size_t self, Entry& out)
+{
+    if (popFrom(*queues[self], out)) return true;
+    for (std::size_t i = 1; i < queues.size(); i++)
+    {
+        if (popFrom(*queues[(self + i) % queues.size()], out)) return true;
+    }
+    return false;
+}
+
+void JobSystem::worker(std::size_t self)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return quit || queued.load() > 0; });
+            if (quit) break;
+        }
+
+        Entry entry;
+        if (!take(self, entry)) continue; // 他のワーカーに先を越された
+        queued.fetch_sub(1);
+
+        if (cancelled(entry.cancel))
+        {
+            unfinished.fetch_sub(1);
+            continue;
+        }
+
+        std::function<void()> then;
+        {
+            ProfileScope scope(entry.name);
+            then = entry.job();
+        }
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finished.push_back({ std::move(then), std::move(entry.cancel) });
+    }
+}
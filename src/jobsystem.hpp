@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 地形生成やメッシュ生成を全コアで回すスレッドプール
+// ワーカーごとに優先度付きのキューを持ち、自分のが空になったら他のワーカーから盗む
+// 続き (ワールドへの追加や GPU への転送) は AssetLoader と同じくメインスレッドの poll で実行する
+class JobSystem {
+public:
+    // ワーカースレッドで実行し、メインスレッドで呼ぶ続きを返す (続きが無ければ空の関数)
+    using Job = std::function<std::function<void()>()>;
+    // true にすると、まだ始まっていないジョブと続きを捨てる
+    using CancelToken = std::shared_ptr<std::atomic<bool>>;
+
+    // threadCount が 0 ならコア数 - 1 (最低 1)
+    explicit JobSystem(int threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static CancelToken makeCancelToken() { return std::make_shared<std::atomic<bool>>(false); }
+
+    // priority が小さいものから先に実行する (カメラからの距離など)
+    // name はプロファイラに出る名前 (文字列リテラル)
+    void run(const char* name, float priority, Job job, CancelToken cancel = nullptr);
+
+    // 終わったジョブの続きを最大 maxContinuations 個、メインスレッドで実行する
+    void poll(int maxContinuations = INT_MAX);
+    // 実行待ち・実行中・続き待ちのジョブ数
+    int pending() const { return unfinished.load(); }
+    int threadCount() const { return static_cast<int>(threads.size()); }
+
+private:
+    struct Entry {
+        const char* name;
+        float priority;
+        std::uint64_t order; // 同じ優先度なら先に入れたもの
+        Job job;
+        CancelToken cancel;
+    };
+
+    struct Finished {
+        std::function<void()> then;
+        CancelToken cancel;
+    };
+
+    // priority の小さいものが先頭に来るヒープ
+    struct Queue {
+        std::mutex mutex;
+        std::vector<Entry> heap;
+    };
+
+    static bool later(const Entry& a, const Entry& b);
+    static bool cancelled(const CancelToken& cancel) { return cancel && cancel->load(); }
+
+    bool popFrom(Queue& queue, Entry& out);
+    bool take(std::size_t self, Entry& out);
+    void worker(std::size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<std::size_t> nextQueue{ 0 };
+    std::atomic<std::uint64_t> nextOrder{ 0 };
+
+    // キューに入っているジョブ数。0 の間ワーカーは眠る
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{ 0 };
+    bool quit = false;
+
+    std::mutex finishedMutex;
+    std::deque<Finished> finished;
+    std::atomic<int> unfinished{ 0 };
+
+    std::vector<std::thread> threads;
+};
@@ -1,26 +1,67 @@
 #include <raylib.h>
+#include <algorithm>
 #include <cmath>  // sinfおよびcosfを使用するために必要
+#include <functional>
 #include <iostream>
-#include <fstream>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-struct Block {
-    int type;
-    float x;
-    float y;
-    float z;
-};
-
-// ブロック情報をファイルに保存
-void saveBlocks(const std::vector<Block>& blocks , const std::string& filename) {
-    std::ofstream file(filename);
-    if (file.is_open()) {
-        for (const auto& block : blocks) {
-            file << block.type << " " << block.x << " " << block.y << " " << block.z << std::endl;
-        }
-        file.close();
-    } else {
-        std::cerr << "ファイルを開けませんでした: " << filename << std::endl;
+#include "assetcache.hpp"
+#include "audio.hpp"
+#include "blocks.hpp"
+#include "chunkrenderer.hpp"
+#include "culling.hpp"
+#include "jobsystem.hpp"
+#include "modellod.hpp"
+#include "physics.hpp"
+#include "profiler.hpp"
+#include "profilerhud.hpp"
+#include "raycast.hpp"
+#include "simulation.hpp"
+#include "terrain.hpp"
+#include "terrainstreamer.hpp"
+#include "world.hpp"
+#include "worldio.hpp"
+
+// raylib の箱を当たり判定の箱に
+static Aabb toAabb(const BoundingBox& box)
+{
+    return { box.min.x, box.min.y, box.min.z, box.max.x, box.max.y, box.max.z };
+}
+
+// コマンドライン引数の数値。全体が数値として読めたときだけ value に入れて true
+static bool parseNumber(const std::string& text, int& value)
+{
+    try
+    {
+        std::size_t used = 0;
+        int parsed = std::stoi(text, &used);
+        if (used != text.size()) return false;
+        value = parsed;
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+static bool parseNumber(const std::string& text, float& value)
+{
+    try
+    {
+        std::size_t used = 0;
+        float parsed = std::stof(text, &used);
+        if (used != text.size()) return false;
+        value = parsed;
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
     }
 }
 
@@ -37,12 +78,49 @@ int main(int argc, char* argv[])
 
     SetExitKey(KEY_NULL);  // ESC キー終了を無効化
 
-    Model sampleobjmodel = LoadModel("resources/OBJ/RubberDuck_LOD0.obj"); // OBJファイル
-    Texture2D tex = LoadTexture("resources/OBJ/RubberDuck_AlbedoTransparency.png"); // OBJファイルの貼り付け画像
-    sampleobjmodel.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = tex; // 田村
+    // 画像やモデルはワーカースレッドで読む (GPU に送るのだけメインスレッド)
+    // 変換済みのものは cache/ に置いて次回からそれを読む
+    AssetCache assetCache;
+    AssetLoader assetLoader;
+
+    Texture2D tex = { 0 }; // OBJファイルの貼り付け画像
+    Shader instancingShader = LoadShader("resources/shaders/instancing.vs", "resources/shaders/instancing.fs");
+    // OBJファイル (遠いものほど粗い LOD で、同じ LOD はまとめて描く)
+    LodModel sampleobjmodel;
+    bool sampleobjBoundsChanged = false; // 当たり判定の箱を作り直す
+    const char* sampleobjLods[] = {
+        "resources/OBJ/RubberDuck_LOD0.obj",
+        "resources/OBJ/RubberDuck_LOD1.obj",
+        "resources/OBJ/RubberDuck_LOD2.obj",
+    };
+    assetLoader.run([&]() -> std::function<void()> {
+        Image image = assetCache.loadImage("resources/OBJ/RubberDuck_AlbedoTransparency.png");
+        return [&, image]() {
+            if (image.data) tex = LoadTextureFromImage(image);
+            UnloadImage(image);
+            sampleobjmodel.init(3, tex, instancingShader); // 田村
+            for (int i = 0; i < 3; i++)
+            {
+                assetLoader.run([&, i]() -> std::function<void()> {
+                    Color diffuse = WHITE;
+                    Mesh mesh = assetCache.loadMesh(sampleobjLods[i], &diffuse);
+                    return [&, i, mesh, diffuse]() mutable {
+                        if (mesh.vertexCount == 0) return;
+                        UploadMesh(&mesh, false);
+                        Model model = LoadModelFromMesh(mesh);
+                        model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = diffuse;
+                        sampleobjmodel.setLod(i, model);
+                        sampleobjBoundsChanged = true;
+                    };
+                });
+            }
+        };
+    });
 
     //SetAudioStreamBufferSizeDefault(4096); 
     InitAudioDevice();
+    AudioSystem audio;
+    audio.start();
 
     // =====================================================================
     // カメラの設定
@@ -54,16 +132,57 @@ int main(int argc, char* argv[])
     camera.projection = CAMERA_PERSPECTIVE;
     // =====================================================================
 
-    std::vector<Block> blocks;
-
-    float cameraSpeed = 0.2f;
-    float cameraRotationY = 0.0f; // カメラの水平回転角度
-    float cameraRotationX = 0.0f; // カメラの垂直回転角度
-    const float mouseSensitivity = 0.003f; // マウス感度
+    // ワールドとセーブファイル (チャンクは使うときにファイルから読む)
+    WorldFile worldFile("world.mgw");
+    worldFile.open();
+    World world; // チャンク単位で持つワールド
+    world.setSource(&worldFile);
+    WorldSaver worldSaver(worldFile);
+    ChunkRenderer chunkRenderer; // チャンクごとの Mesh
+    chunkRenderer.load(assetCache, assetLoader); // ブロックのアトラスは読み込みスレッドで作る
+    // 地形はプレイヤーの周りをワーカースレッドで作る (メッシュ生成も同じスレッドプールで)
+    TerrainGenerator terrainGenerator;
+    JobSystem jobSystem;
+    TerrainStreamer terrainStreamer(terrainGenerator, jobSystem);
+    // 遠くのチャンクはメモリの上限を超えたらセーブファイルに追い出す (戻ってきたらそこから読む)
+    terrainStreamer.setStorage(worldFile, worldSaver);
+    const double autoSaveInterval = 60.0; // 秒
+    double lastAutoSave = GetTime();
+
+    camera.position.y = terrainGenerator.heightAt(0, 4) + 0.5f + PLAYER_EYE_HEIGHT; // 地面の少し上から始める
+    camera.target.y = camera.position.y;
+    // プレイヤーの移動と当たり判定は別スレッドで 1/60 秒ごとに進める (描画のフレームレートに依らない)
+    // 地形の高さの範囲でチャンクがまだ無いところでは、できるまで落ちずに待つ
+    Simulation simulation({ camera.position.x, camera.position.y - PLAYER_EYE_HEIGHT, camera.position.z, 0.0f, 0.0f }, world);
+    simulation.setRequiredChunkRange(terrainGenerator.minChunkY(), terrainGenerator.maxChunkY());
+    bool flying = false; // F で切り替え
 
     Vector3 sampleobjpos = {0.0f,0.0f,0.0f};
     Vector3 sampleobjpos2 = {200.0f,1.0f,0.0f};
-    BoundingBox sampleobjbounds = GetMeshBoundingBox(sampleobjmodel.meshes[0]);
+    sampleobjmodel.addInstance(sampleobjpos, 0.01f);
+    sampleobjmodel.addInstance(sampleobjpos2, 0.01f);
+
+    // 動かない置き物の当たり判定 (モデルは外接箱で)。モデルの大きさがわかるたびに作り直す
+    auto updateStaticColliders = [&]() {
+        std::vector<Aabb> colliders = {
+            toAabb(cubeBounds((Vector3){ 0.0f, 20.0f, 0.0f }, 10.0f, 5.0f, 10.0f)),
+            toAabb(cubeBounds((Vector3){ 1.0f, 0.5f, 0.0f }, 1.0f, 1.0f, 1.0f)),
+        };
+        if (sampleobjBoundsChanged)
+        {
+            colliders.push_back(toAabb(placeBox(sampleobjmodel.bounds(), sampleobjpos, 0.01f)));
+            colliders.push_back(toAabb(placeBox(sampleobjmodel.bounds(), sampleobjpos2, 0.01f)));
+        }
+        simulation.setStaticColliders(colliders);
+    };
+    updateStaticColliders();
+
+    const float blockReach = 8.0f; // クリックで届くブロックまでの距離
+    BlockId placeBlockType = BLOCK_STONE;
+    RayHit pickedBlock;
+
+    float viewDistance = 160.0f; // これより遠いものは描かない (--view-distance で変更)
+    const float maxViewDistance = 1024.0f; // これより先まで読むとチャンクの一覧が大きくなりすぎる
 
     // グリッド
     bool sampleZimen = false;
@@ -88,21 +207,44 @@ int main(int argc, char* argv[])
     Rectangle soundRect = { 200, 50, 50, 50 };
     Rectangle mouseHayashiRect = { 200, 150, 50, 50 };
 
-    Image BackImageSample = LoadImage("resources/Title/BackImage/BackImage.png");
-    ImageResize(&BackImageSample, 800, 600);
-    Texture2D BackTextureSample = LoadTextureFromImage(BackImageSample);
-    UnloadImage(BackImageSample);
-
-    Image mouseImageSample = LoadImage("resources/mouse/moouse.png");
-    ImageResize(&mouseImageSample, 50, 50);
-    Texture2D mouseTextureSample = LoadTextureFromImage(mouseImageSample);
-    UnloadImage(mouseImageSample);
-
-    Music titleMusic = LoadMusicStream("Music/IkeIke/ヤジュセンパイイキスギンイクイクアッアッアッアーヤリマスネ(コウジの回想) ハクシンしんちゃん 嵐を呼ぶ ブッチッパ! ホモビ 帝国の逆襲 劇中歌.mp3.mp3");
-    titleMusic.stream.sampleRate = 44100; 
-    SetMusicVolume(titleMusic, 1.0f);
-
-    SetTargetFPS(30);
+    // 読み込みが終わるまでは id が 0 のまま
+    Texture2D BackTextureSample = { 0 };
+    assetLoader.run([&]() -> std::function<void()> {
+        Image BackImageSample = assetCache.loadImage("resources/Title/BackImage/BackImage.png", 800, 600);
+        return [&, BackImageSample]() {
+            if (BackImageSample.data) BackTextureSample = LoadTextureFromImage(BackImageSample);
+            UnloadImage(BackImageSample);
+        };
+    });
+
+    Texture2D mouseTextureSample = { 0 };
+    assetLoader.run([&]() -> std::function<void()> {
+        Image mouseImageSample = assetCache.loadImage("resources/mouse/moouse.png", 50, 50);
+        return [&, mouseImageSample]() {
+            if (mouseImageSample.data) mouseTextureSample = LoadTextureFromImage(mouseImageSample);
+            UnloadImage(mouseImageSample);
+        };
+    });
+
+    // BGM は音声スレッドで読み込んで流す。効果音は先にデコードしておく
+    audio.playMusic("Music/IkeIke/ヤジュセンパイイキスギンイクイクアッアッアッアーヤリマスネ(コウジの回想) ハクシンしんちゃん 嵐を呼ぶ ブッチッパ! ホモビ 帝国の逆襲 劇中歌.mp3.mp3");
+    AudioSystem::ClipId startClip = AudioSystem::NO_CLIP;
+    AudioSystem::ClipId breakClip = AudioSystem::NO_CLIP;
+    AudioSystem::ClipId placeClip = AudioSystem::NO_CLIP;
+    assetLoader.run([&]() -> std::function<void()> {
+        AudioSystem::ClipId yes = audio.loadClip("Music/MURYes.mp3");
+        AudioSystem::ClipId stop = audio.loadClip("Music/KMRStop.mp3");
+        AudioSystem::ClipId pocchama = audio.loadClip("Music/MURPocchama.mp3");
+        return [&, yes, stop, pocchama]() {
+            startClip = yes;
+            breakClip = stop;
+            placeClip = pocchama;
+        };
+    });
+
+    int targetFps = 30; // 0 なら上限なし (--fps で変更)
+    const int maxTargetFps = 1000;
+    int memoryBudgetMb = 64; // チャンクに使うメモリの上限 (--memory-budget で変更)
 
 //========================================================================================================================
     std::string titleCheck;
@@ -113,6 +255,47 @@ int main(int argc, char* argv[])
 	{
 	    DevelopMode = true;
         }
+	if ((std::string(argv[i]) == "--view-distance" || std::string(argv[i]) == "-v") && i + 1 < argc)
+	{
+	    std::string text = argv[++i];
+	    float value = 0.0f;
+	    if (parseNumber(text, value) && value > 0.0f)
+	    {
+		viewDistance = std::min(value, maxViewDistance);
+	    }
+	    else
+	    {
+		std::cerr << "--view-distance には 0 より大きい数 (ブロック) を指定してください: \"" << text << "\" (" << viewDistance << " のまま続けます)" << std::endl;
+	    }
+	}
+	if (std::string(argv[i]) == "--fps" && i + 1 < argc)
+	{
+	    // 0 は上限なし。数字でないものや負の数は受け付けずに今の値のまま
+	    std::string text = argv[++i];
+	    int value = 0;
+	    if (parseNumber(text, value) && value >= 0)
+	    {
+		targetFps = std::min(value, maxTargetFps);
+	    }
+	    else
+	    {
+		std::cerr << "--fps には 0 (上限なし) 以上の整数を指定してください: \"" << text << "\" (" << targetFps << " のまま続けます)" << std::endl;
+	    }
+	}
+	if (std::string(argv[i]) == "--memory-budget" && i + 1 < argc)
+	{
+	    // 数字でないものや 0 以下は受け付けずに今の値のまま
+	    std::string text = argv[++i];
+	    int value = 0;
+	    if (parseNumber(text, value) && value > 0)
+	    {
+		memoryBudgetMb = value;
+	    }
+	    else
+	    {
+		std::cerr << "--memory-budget には 1 以上の整数 (MB) を指定してください: \"" << text << "\" (" << memoryBudgetMb << " MB のまま続けます)" << std::endl;
+	    }
+	}
 	if (std::string(argv[i]) == "--title" || std::string(argv[i]) == "-t")
 	{
 	    std::cout << "タイトル画面を本当に表示しませんか？ [Y/n] ";
@@ -129,9 +312,31 @@ int main(int argc, char* argv[])
 	}
     }
 //========================================================================================================================
+    SetTargetFPS(targetFps);
+    terrainStreamer.setMemoryBudget(static_cast<std::size_t>(memoryBudgetMb) * 1024 * 1024);
+    simulation.start();
     DisableCursor();
     while (!WindowShouldClose())
     {
+        profiler().beginFrame();
+        int frameDrawCalls = 0;
+        int frameTriangles = 0;
+
+        // 読み込みが終わったものを GPU に送る
+        assetLoader.poll();
+        if (sampleobjBoundsChanged)
+        {
+            updateStaticColliders();
+            sampleobjBoundsChanged = false;
+        }
+        {
+        PROFILE_SCOPE("world streaming");
+        // できたチャンクをワールドに入れ、メッシュを GPU に送る (1 フレームでやりすぎない)
+        // 遠くのチャンクはメモリの上限を超えたら追い出す
+        jobSystem.poll(64);
+        terrainStreamer.update(world, camera.position.x, camera.position.y, camera.position.z, viewDistance);
+        }
+
         if (IsKeyDown(KEY_F5))
         {
 	        if (DevelopMode) DevelopMode = false;
@@ -144,14 +349,21 @@ int main(int argc, char* argv[])
 	          if (title) title = false;
 	          else if (!title) title = true;
 	        }
+	        // 直近のフレームの計測結果を書き出す
+	        if (IsKeyPressed(KEY_F6))
+	        {
+	          profiler().exportChromeTrace("profile_trace.json", Profiler::FRAME_CAPACITY);
+	          profiler().exportCsv("profile_frames.csv", Profiler::FRAME_CAPACITY);
+	          std::cout << "profile_trace.json と profile_frames.csv に書き出しました" << std::endl;
+	        }
 	      }
 		
-        if (sound && !IsMusicStreamPlaying(titleMusic)) PlayMusicStream(titleMusic);
-        UpdateMusicStream(titleMusic);
         if (title)
         {
 	      IsCursorOnScreen();
-            if (sound) PlayMusicStream(titleMusic);
+            PlayerInput idle; // タイトル中はプレイヤーを止めておく
+            idle.fly = flying;
+            simulation.addInput(idle);
             Vector2 mousePoint = GetMousePosition();
             // マウス座標を小さな矩形に変換
             Rectangle mouseRect = { mousePoint.x, mousePoint.y, 1, 1 };
@@ -163,13 +375,16 @@ int main(int argc, char* argv[])
             bool callEndSet = CheckCollisionRecs(startEndSet, mouseRect);
             bool mouseHayashi = CheckCollisionRecs(mouseHayashiRect, mouseRect);
             
+            {
+            PROFILE_SCOPE("render");
             BeginDrawing();
             ClearBackground(RAYWHITE);
 
             //DrawTexture(BackTexture, 0, 0, WHITE);
             //DrawTexture(BackTextureLogo, 0, 0, WHITE);
             //DrawTexture(BackTextureButton, 0, 0, WHITE);
-            DrawTexture(BackTextureSample, 0, 0, WHITE);
+            if (BackTextureSample.id > 0) DrawTexture(BackTextureSample, 0, 0, WHITE);
+            if (assetLoader.pending() > 0) DrawText("Loading...", 10, screenHeight - 30, 20, DARKGRAY);
 
             //DrawTexture(mouseTextureSample, mouseRect.x, mouseRect.y, WHITE);
 
@@ -177,7 +392,11 @@ int main(int argc, char* argv[])
             {
                 if (titSet)
                 {
-                    if (callStart) title = false;
+                    if (callStart)
+                    {
+                        title = false;
+                        audio.play(startClip);
+                    }
                     if (callSetting) setting = true;
                     if (callEnd) break;
                 }
@@ -193,6 +412,7 @@ int main(int argc, char* argv[])
                     {
                         if (sound) sound = false;
                         else if (!sound) sound = true;
+                        audio.setEnabled(sound);
                     }
                     if (callEndSet) break;
                 }
@@ -208,34 +428,44 @@ int main(int argc, char* argv[])
                 DrawRectangle (screenWidth / 2 - 50, 500, 100, 40, WHITE);
                 DrawText ("Ikuma no purupuru na Abura", screenWidth / 2 - 50, 500, 40, BLACK);
             }
-            DrawTexture(mouseTextureSample, mouseRect.x, mouseRect.y, BLACK);
-
+            if (mouseTextureSample.id > 0) DrawTexture(mouseTextureSample, mouseRect.x, mouseRect.y, BLACK);
+            }
+            {
+            // 画面の入れ替えと SetTargetFPS の待ちは描画と分けて測る
+            PROFILE_SCOPE("present");
             EndDrawing();
+            }
         }
         else if (!title)
         {
 	        // ESCキーで終了 + セーブ
           if (IsKeyPressed(KEY_ESCAPE))
           {
-            if (blocks.empty()) // すでにブロック追加済みか確認
+            std::unique_lock<std::shared_mutex> worldLock(world.mutex());
+            if (world.blockCount() == 0) // すでにブロック追加済みか確認
             {
               // 例: 初期ブロックを1度だけ追加
-              Block block1 = {1, 0.0f, 0.0f, 0.0f};
-              Block block2 = {2, 1.0f, 2.0f, 3.0f};
-              blocks.push_back(block1);
-              blocks.push_back(block2);
+              world.setBlock(0, 0, 0, 1);
+              world.setBlock(1, 2, 3, 2);
             }
-            std::cout << "ブロック数: " << blocks.size() << std::endl;
-            saveBlocks(blocks, "blocks.txt");  
+            std::cout << "ブロック数: " << world.blockCount() << std::endl;
+            // 書き込みはセーブスレッドで。終了前に待つ
+            worldSaver.requestSave(world);
             break;
           }
 
 
-	  // ブロックを追加 (例)
-          Block block1 = {1, 0.0f, 0.0f, 0.0f};
-          Block block2 = {2, 1.0f, 2.0f, 3.0f};
-          blocks.push_back(block1);
-          blocks.push_back(block2);
+          {
+          PROFILE_SCOPE("world save");
+          // 書き終えたと確かめられたチャンクだけ変更なしにする (失敗したものは次でもう一度)
+          worldSaver.applySaved(world);
+          // オートセーブ (変更のあったチャンクだけ)
+          if (GetTime() - lastAutoSave > autoSaveInterval)
+          {
+            worldSaver.requestSave(world);
+            lastAutoSave = GetTime();
+          }
+          }
 
           //HideCursor();
           //Vector2 mousePos = GetMousePosition();
@@ -247,38 +477,28 @@ int main(int argc, char* argv[])
           //  SetMousePosition(clampedX, clampedY);
           //}
          
+          {
+          PROFILE_SCOPE("input");
+          // 入力を集めてシミュレーションスレッドに渡す (動かすのは向こうで固定タイムステップ)
           Vector2 mouseDelta = GetMouseDelta();
-
-            cameraRotationY -= mouseDelta.x * mouseSensitivity; // 水平回転の符号を反転
-            cameraRotationX -= mouseDelta.y * mouseSensitivity; // 垂直回転の符号を反転
-
-
-            // 垂直回転の制限
-            if (cameraRotationX > PI/2.0f - 0.01f) cameraRotationX = PI/2.0f - 0.01f;
-            if (cameraRotationX < -PI/2.0f + 0.01f) cameraRotationX = -PI/2.0f + 0.01f;
-
-            // カメラの移動
-            Vector3 forward = { sinf(cameraRotationY), 0.0f, cosf(cameraRotationY) };
-            Vector3 right = { cosf(cameraRotationY), 0.0f, -sinf(cameraRotationY) };
-
-            if (IsKeyDown(KEY_W)) {
-                camera.position.x += forward.x * cameraSpeed;
-                camera.position.z += forward.z * cameraSpeed;
-            }
-            if (IsKeyDown(KEY_S)) {
-                camera.position.x -= forward.x * cameraSpeed;
-                camera.position.z -= forward.z * cameraSpeed;
-            }
-            if (IsKeyDown(KEY_A)) {
-                camera.position.x += right.x * cameraSpeed;
-                camera.position.z += right.z * cameraSpeed;
-            }
-            if (IsKeyDown(KEY_D)) {
-                camera.position.x -= right.x * cameraSpeed;
-                camera.position.z -= right.z * cameraSpeed;
-            }
-            if (IsKeyDown(KEY_SPACE)) camera.position.y += cameraSpeed;
-            if (IsKeyDown(KEY_LEFT_SHIFT)) camera.position.y -= cameraSpeed;
+          PlayerInput input;
+          input.forward = IsKeyDown(KEY_W);
+          input.back = IsKeyDown(KEY_S);
+          input.left = IsKeyDown(KEY_A);
+          input.right = IsKeyDown(KEY_D);
+          input.up = IsKeyDown(KEY_SPACE);
+          input.down = IsKeyDown(KEY_LEFT_SHIFT);
+          if (IsKeyPressed(KEY_F)) flying = !flying;
+          input.fly = flying;
+          input.lookX = mouseDelta.x;
+          input.lookY = mouseDelta.y;
+          simulation.addInput(input);
+
+            // 置くブロックの種類
+            if (IsKeyPressed(KEY_ONE)) placeBlockType = BLOCK_STONE;
+            if (IsKeyPressed(KEY_TWO)) placeBlockType = BLOCK_DIRT;
+            if (IsKeyPressed(KEY_THREE)) placeBlockType = BLOCK_GRASS;
+            if (IsKeyPressed(KEY_FOUR)) placeBlockType = BLOCK_SAND;
 
             if (IsKeyDown(KEY_F3)) if (IsKeyPressed(KEY_B))
             {
@@ -291,34 +511,101 @@ int main(int argc, char* argv[])
                     sampleZimen = true;
                 }
             }
+          }
 
-            // カメラのターゲット位置を更新
+            // 直近 2 tick の間を補間してカメラを置く
+            PlayerState view = simulation.interpolated();
+            camera.position = (Vector3){ view.x, view.y + PLAYER_EYE_HEIGHT, view.z };
             camera.target = (Vector3){
-                camera.position.x + cosf(cameraRotationX) * sinf(cameraRotationY),
-                camera.position.y + sinf(cameraRotationX),
-                camera.position.z + cosf(cameraRotationX) * cosf(cameraRotationY)
+                view.x + cosf(view.pitch) * sinf(view.yaw),
+                view.y + sinf(view.pitch),
+                view.z + cosf(view.pitch) * cosf(view.yaw)
+            };
+
+            {
+            PROFILE_SCOPE("block pick");
+            // 視線の先のブロック。左クリックで壊して、右クリックで当たった面の手前に置く
+            VoxelRay ray = {
+                camera.position.x, camera.position.y, camera.position.z,
+                camera.target.x - camera.position.x, camera.target.y - camera.position.y, camera.target.z - camera.position.z,
+                blockReach
             };
+            pickedBlock = raycastVoxels(world, ray);
+            if (pickedBlock.hit && IsMouseButtonPressed(MOUSE_LEFT_BUTTON))
+            {
+                std::unique_lock<std::shared_mutex> worldLock(world.mutex());
+                world.setBlock(pickedBlock.x, pickedBlock.y, pickedBlock.z, BLOCK_AIR);
+                audio.play(breakClip, 0.6f, GetRandomValue(90, 110) / 100.0f);
+            }
+            else if (pickedBlock.hit && IsMouseButtonPressed(MOUSE_RIGHT_BUTTON))
+            {
+                int px = pickedBlock.x + pickedBlock.normalX;
+                int py = pickedBlock.y + pickedBlock.normalY;
+                int pz = pickedBlock.z + pickedBlock.normalZ;
+                // 自分の体と重なるところには置かない
+                // 補間した view は 1 tick 遅れているので、ロックで tick を止めてから最新の位置で確かめる
+                std::unique_lock<std::shared_mutex> worldLock(world.mutex());
+                PlayerState current = simulation.latest();
+                PhysicsBody playerBody;
+                playerBody.x = current.x;
+                playerBody.y = current.y;
+                playerBody.z = current.z;
+                Aabb cell = { (float)px, (float)py, (float)pz, px + 1.0f, py + 1.0f, pz + 1.0f };
+                if (!cell.overlaps(playerBody.bounds()))
+                {
+                    world.setBlock(px, py, pz, placeBlockType);
+                    audio.play(placeClip, 0.6f, GetRandomValue(90, 110) / 100.0f);
+                }
+            }
+            }
 
+            {
+            PROFILE_SCOPE("mesh rebuild");
+            // 変更のあったチャンクだけ Mesh を作り直す (ワーカースレッドで)
+            chunkRenderer.update(world, jobSystem, camera.position);
+            }
 
+            {
+            PROFILE_SCOPE("render");
             BeginDrawing();
 
             ClearBackground(SKYBLUE);
 
+            // 画面に映らないもの・遠すぎるものは描かない
+            Frustum frustum = makeFrustum(camera, (float)GetScreenWidth() / (float)GetScreenHeight(), viewDistance);
+            CullStats cullStats;
+
             BeginMode3D(camera);
+
+            chunkRenderer.draw(frustum, cullStats);
 	    
-	    DrawCube((Vector3){0.0f, 20.0f, 0.0f}, 10.0f, 5.0f, 10.0f, WHITE);
-	    DrawCubeWires((Vector3){0.0f, 20.0f, 0.0f}, 10.0f, 5.0f, 10.0f, GRAY);
+	    if (cullStats.test(frustum, cubeBounds((Vector3){0.0f, 20.0f, 0.0f}, 10.0f, 5.0f, 10.0f)))
+	    {
+	        DrawCube((Vector3){0.0f, 20.0f, 0.0f}, 10.0f, 5.0f, 10.0f, WHITE);
+	        DrawCubeWires((Vector3){0.0f, 20.0f, 0.0f}, 10.0f, 5.0f, 10.0f, GRAY);
+	    }
 
+            if (cullStats.test(frustum, cubeBounds((Vector3){camera.position.x + 20, 0.0f, 0.0f}, 0.5f, 0.5f, 0.5f)))
+                DrawCube((Vector3){camera.position.x + 20, 0.0f, 0.0f}, 0.5f, 0.5f, 0.5f, GREEN);
 
-            DrawCube((Vector3){camera.position.x + 20, 0.0f, 0.0f}, 0.5f, 0.5f, 0.5f, GREEN);
+            if (cullStats.test(frustum, cubeBounds((Vector3){ 1.0f, 0.5f, 0.0f }, 1.0f, 1.0f, 1.0f)))
+            {
+                DrawCube((Vector3){ 1.0f, 0.5f, 0.0f }, 1.0f, 1.0f, 1.0f, RED);
+                DrawCubeWires((Vector3){ 1.0f, 0.5f, 0.0f }, 1.0f, 1.0f, 1.0f, MAROON);
+            }
 
-            DrawCube((Vector3){ 1.0f, 0.5f, 0.0f }, 1.0f, 1.0f, 1.0f, RED);
-            DrawCubeWires((Vector3){ 1.0f, 0.5f, 0.0f }, 1.0f, 1.0f, 1.0f, MAROON);
+            if (pickedBlock.hit)
+            {
+                Vector3 center = { pickedBlock.x + 0.5f, pickedBlock.y + 0.5f, pickedBlock.z + 0.5f };
+                DrawCubeWires(center, 1.01f, 1.01f, 1.01f, BLACK);
+            }
 
-            DrawModel(sampleobjmodel, sampleobjpos, 0.01f, WHITE);
-            DrawModel(sampleobjmodel, sampleobjpos2, 0.01f, WHITE);
+            sampleobjmodel.draw(camera, frustum, cullStats);
+            frameDrawCalls = chunkRenderer.drawCalls() + sampleobjmodel.drawCalls();
+            frameTriangles = chunkRenderer.drawnTriangles() + sampleobjmodel.drawnTriangles();
 
-            if (sampleZimen)
+            // DrawGrid(20, 10.0f) は原点中心の 200x200
+            if (sampleZimen && cullStats.test(frustum, cubeBounds((Vector3){ 0.0f, 0.0f, 0.0f }, 200.0f, 0.0f, 200.0f)))
             {
                 ////グリッドの描画
                 //for (int x = -10; x <= 10; x++) {
@@ -332,15 +619,45 @@ int main(int argc, char* argv[])
             }
 
                 EndMode3D();
+
+                // 照準
+                DrawLine(screenWidth / 2 - 8, screenHeight / 2, screenWidth / 2 + 8, screenHeight / 2, WHITE);
+                DrawLine(screenWidth / 2, screenHeight / 2 - 8, screenWidth / 2, screenHeight / 2 + 8, WHITE);
             
                 // カメラ位置の表示
                 DrawText(TextFormat("Camera Position: [%.2f, %.2f, %.2f]", camera.position.x, camera.position.y, camera.position.z), 10, 10, 20, DARKGRAY);
-           
+                if (DevelopMode)
+                {
+                    DrawText(TextFormat("Drawn: %d  Culled: %d  Chunks: %d  Generating: %d", cullStats.drawn, cullStats.culled,
+                                        (int)world.chunkCount(), terrainStreamer.pending()), 10, 35, 20, DARKGRAY);
+                    DrawText(TextFormat("Resident: %d chunks  %.1f MB  Evicted: %d", (int)terrainStreamer.residentChunks(),
+                                        terrainStreamer.residentBytes() / (1024.0 * 1024.0), (int)terrainStreamer.evictedChunks()),
+                             10, 60, 20, DARKGRAY);
+                    drawProfilerOverlay(profiler(), 10, 85, targetFps);
+                }
+            }
+            {
+            // 画面の入れ替えと SetTargetFPS の待ちは描画と分けて測る
+            PROFILE_SCOPE("present");
             EndDrawing();
             }
+            }
+
+        profiler().endFrame(frameDrawCalls, frameTriangles);
     }
 
-    UnloadMusicStream(titleMusic);
+    // ローダーのジョブはこの下で壊すもの (audio やモデルなど) を参照しているので先に止める
+    assetLoader.stop();
+    simulation.stop();
+    worldSaver.wait();
+    chunkRenderer.unload();
+    sampleobjmodel.unload();
+    UnloadShader(instancingShader);
+    UnloadTexture(tex);
+    UnloadTexture(BackTextureSample);
+    UnloadTexture(mouseTextureSample);
+
+    audio.stop();
     CloseAudioDevice();
     CloseWindow();
 
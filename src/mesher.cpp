@@ -0,0 +1,203 @@
+#include "mesher.hpp"
+
+#include <cstring>
+
+#include "blocks.hpp"
+
+namespace {
+
+// 面の向きごとの明るさ (ライティング無しでも形がわかるように)
+// 軸 (x, y, z) x 向き (+, -)
+const float FACE_SHADE[3][2] = {
+    { 0.8f, 0.8f },
+    { 1.0f, 0.5f },
+    { 0.65f, 0.65f },
+};
+
+void emitQuad(ChunkMeshData& out, int d, bool positive, const int origin[3], int w, int h, BlockId type)
+{
+    int u = (d + 1) % 3;
+    int v = (d + 2) % 3;
+
+    float corners[4][3];
+    for (int k = 0; k < 4; k++)
+    {
+        for (int a = 0; a < 3; a++) corners[k][a] = static_cast<float>(origin[a]);
+    }
+    corners[1][u] += w;
+    corners[2][u] += w;
+    corners[2][v] += h;
+    corners[3][v] += h;
+
+    float normal[3] = { 0.0f, 0.0f, 0.0f };
+    normal[d] = positive ? 1.0f : -1.0f;
+
+    // 上下の面は上・下のタイル、それ以外は横のタイル
+    BlockFace face = d != 1 ? FACE_SIDE : (positive ? FACE_TOP : FACE_BOTTOM);
+    float tile[2] = { static_cast<float>(blockRegistry().tileOf(type, face)), 0.0f };
+    std::uint8_t shade = static_cast<std::uint8_t>(255 * FACE_SHADE[d][positive ? 0 : 1]);
+
+    std::uint16_t first = static_cast<std::uint16_t>(out.vertexCount());
+    for (int k = 0; k < 4; k++)
+    {
+        out.vertices.insert(out.vertices.end(), corners[k], corners[k] + 3);
+        out.normals.insert(out.normals.end(), normal, normal + 3);
+        // UV はブロック座標そのまま (1 ブロックで 1 回繰り返す)。横の面は画像の上を +y に向ける
+        if (d == 1)
+        {
+            out.texcoords.push_back(corners[k][0]);
+            out.texcoords.push_back(corners[k][2]);
+        }
+        else
+        {
+            out.texcoords.push_back(d == 0 ? corners[k][2] : corners[k][0]);
+            out.texcoords.push_back(-corners[k][1]);
+        }
+        out.tiles.insert(out.tiles.end(), tile, tile + 2);
+        for (int c = 0; c < 3; c++) out.colors.push_back(shade);
+        out.colors.push_back(255);
+    }
+
+    // u x v = +d なので + 向きの面はそのまま反時計回り、- 向きは裏返す
+    if (positive)
+    {
+        const std::uint16_t idx[6] = { 0, 1, 2, 0, 2, 3 };
+        for (std::uint16_t i : idx) out.indices.push_back(static_cast<std::uint16_t>(first + i));
+    }
+    else
+    {
+        const std::uint16_t idx[6] = { 0, 2, 1, 0, 3, 2 };
+        for (std::uint16_t i : idx) out.indices.push_back(static_cast<std::uint16_t>(first + i));
+    }
+}
+
+} // namespace
+
+void gatherPaddedChunk(const World& world, const ChunkCoord& coord, PaddedChunk& out)
+{
+    out.blocks.fill(BLOCK_AIR);
+
+    if (const Chunk* chunk = world.findLoadedChunk(coord))
+    {
+        for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        {
+            std::memcpy(&out.blocks[PaddedChunk::index(0, y, z)],
+                        &chunk->blocks[Chunk::index(0, y, z)], CHUNK_SIZE);
+        }
+    }
+
+    // 面で接する隣のチャンクの境界 1 枚ずつ
+    const int last = CHUNK_SIZE - 1;
+    if (const Chunk* n = world.findLoadedChunk({ coord.x - 1, coord.y, coord.z }))
+        for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++) out.blocks[PaddedChunk::index(-1, y, z)] = n->get(last, y, z);
+    if (const Chunk* n = world.findLoadedChunk({ coord.x + 1, coord.y, coord.z }))
+        for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int z = 0; z < CHUNK_SIZE; z++) out.blocks[PaddedChunk::index(CHUNK_SIZE, y, z)] = n->get(0, y, z);
+    if (const Chunk* n = world.findLoadedChunk({ coord.x, coord.y - 1, coord.z }))
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        for (int x = 0; x < CHUNK_SIZE; x++) out.blocks[PaddedChunk::index(x, -1, z)] = n->get(x, last, z);
+    if (const Chunk* n = world.findLoadedChunk({ coord.x, coord.y + 1, coord.z }))
+        for (int z = 0; z < CHUNK_SIZE; z++)
+        for (int x = 0; x < CHUNK_SIZE; x++) out.blocks[PaddedChunk::index(x, CHUNK_SIZE, z)] = n->get(x, 0, z);
+    if (const Chunk* n = world.findLoadedChunk({ coord.x, coord.y, coord.z - 1 }))
+        for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int x = 0; x < CHUNK_SIZE; x++) out.blocks[PaddedChunk::index(x, y, -1)] = n->get(x, y, last);
+    if (const Chunk* n = world.findLoadedChunk({ coord.x, coord.y, coord.z + 1 }))
+        for (int y = 0; y < CHUNK_SIZE; y++)
+        for (int x = 0; x < CHUNK_SIZE; x++) out.blocks[PaddedChunk::index(x, y, CHUNK_SIZE)] = n->get(x, y, 0);
+}
+
+void ChunkMeshData::clear()
+{
+    vertices.clear();
+    normals.clear();
+    texcoords.clear();
+    tiles.clear();
+    colors.clear();
+    indices.clear();
+}
+
+void greedyMesh(const PaddedChunk& chunk, ChunkMeshData& out)
+{
+    out.clear();
+
+    // マスクの値: + なら +d 向きの面、- なら -d 向きの面、0 は面なし
+    int mask[CHUNK_SIZE * CHUNK_SIZE];
+    // 種類ごとの不透明かどうかを先に引いておく
+    bool opaque[256];
+    for (int id = 0; id < 256; id++) opaque[id] = blockRegistry().isOpaque(static_cast<BlockId>(id));
+
+    for (int d = 0; d < 3; d++)
+    {
+        int u = (d + 1) % 3;
+        int v = (d + 2) % 3;
+        int x[3] = { 0, 0, 0 };
+
+        // s 枚目の平面は s-1 番目と s 番目のブロックの境目
+        for (int s = 0; s <= CHUNK_SIZE; s++)
+        {
+            for (x[v] = 0; x[v] < CHUNK_SIZE; x[v]++)
+            for (x[u] = 0; x[u] < CHUNK_SIZE; x[u]++)
+            {
+                int pa[3] = { x[0], x[1], x[2] };
+                int pb[3] = { x[0], x[1], x[2] };
+                pa[d] = s - 1;
+                pb[d] = s;
+                BlockId a = chunk.get(pa[0], pa[1], pa[2]);
+                BlockId b = chunk.get(pb[0], pb[1], pb[2]);
+
+                int m = 0;
+                // 隣がこのチャンクの外なら、その面は隣のチャンクが出す
+                // 向こうが見えないブロックと接している面は描かない
+                if (a != b)
+                {
+                    if (a != BLOCK_AIR && !opaque[b] && s >= 1) m = a;
+                    else if (b != BLOCK_AIR && !opaque[a] && s < CHUNK_SIZE) m = -b;
+                }
+                mask[x[u] + CHUNK_SIZE * x[v]] = m;
+            }
+
+            // 同じ値の長方形をまとめて 1 枚の面にする
+            for (int j = 0; j < CHUNK_SIZE; j++)
+            for (int i = 0; i < CHUNK_SIZE;)
+            {
+                int m = mask[i + CHUNK_SIZE * j];
+                if (m == 0)
+                {
+                    i++;
+                    continue;
+                }
+
+                int w = 1;
+                while (i + w < CHUNK_SIZE && mask[i + w + CHUNK_SIZE * j] == m) w++;
+
+                int h = 1;
+                for (; j + h < CHUNK_SIZE; h++)
+                {
+                    bool rowMatches = true;
+                    for (int k = 0; k < w; k++)
+                    {
+                        if (mask[i + k + CHUNK_SIZE * (j + h)] != m)
+                        {
+                            rowMatches = false;
+                            break;
+                        }
+                    }
+                    if (!rowMatches) break;
+                }
+
+                int origin[3];
+                origin[d] = s;
+                origin[u] = i;
+                origin[v] = j;
+                emitQuad(out, d, m > 0, origin, w, h, static_cast<BlockId>(m > 0 ? m : -m));
+
+                for (int l = 0; l < h; l++)
+                for (int k = 0; k < w; k++) mask[i + k + CHUNK_SIZE * (j + l)] = 0;
+                i += w;
+            }
+        }
+    }
+}
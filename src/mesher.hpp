@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "world.hpp"
+
+// チャンクの周囲 1 ブロックぶんを足したブロック配列 (隣のチャンクとの境界の面を消すため)
+constexpr int PADDED_SIZE = CHUNK_SIZE + 2;
+
+struct PaddedChunk {
+    std::array<BlockId, PADDED_SIZE * PADDED_SIZE * PADDED_SIZE> blocks{};
+
+    // -1 .. CHUNK_SIZE のローカル座標
+    static int index(int x, int y, int z)
+    {
+        return (x + 1) + PADDED_SIZE * ((z + 1) + PADDED_SIZE * (y + 1));
+    }
+    BlockId get(int x, int y, int z) const { return blocks[index(x, y, z)]; }
+};
+
+// メモリにあるチャンクと、その 6 方向の隣の境界をコピーする (隣は読み込みしない)
+void gatherPaddedChunk(const World& world, const ChunkCoord& coord, PaddedChunk& out);
+
+// GPU に送る前の頂点データ (座標はチャンク内のローカル座標)
+struct ChunkMeshData {
+    std::vector<float> vertices;        // xyz
+    std::vector<float> normals;         // xyz
+    std::vector<float> texcoords;       // uv (ブロック 1 つで 1 回繰り返す)
+    std::vector<float> tiles;           // アトラスのタイル番号, 0 (texcoords2 として送る)
+    std::vector<std::uint8_t> colors;   // rgba (面の向きごとの明るさ)
+    std::vector<std::uint16_t> indices;
+
+    void clear();
+    int vertexCount() const { return static_cast<int>(vertices.size() / 3); }
+    int triangleCount() const { return static_cast<int>(indices.size() / 3); }
+};
+
+// 隠れた面を捨て、同じ種類で同じ平面の面をまとめる (greedy meshing)
+void greedyMesh(const PaddedChunk& chunk, ChunkMeshData& out);
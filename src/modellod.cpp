@@ -0,0 +1,127 @@
+#include "modellod.hpp"
+
+#include <raymath.h>
+
+#include <cmath>
+
+namespace {
+
+// 切り替えの境目でちらつかないよう、境目の前後 ±15% は今の LOD のままにする
+constexpr float LOD_HYSTERESIS = 0.15f;
+
+} // namespace
+
+void LodModel::init(int lodCount, Texture2D texture, Shader instancingShader)
+{
+    lods.assign(lodCount, Model{});
+    batches.resize(lodCount);
+    this->texture = texture;
+    shader = instancingShader;
+    shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+}
+
+void LodModel::setLod(int level, Model model)
+{
+    for (int i = 0; i < model.materialCount; i++)
+    {
+        model.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture = texture;
+    }
+    if (lods[level].meshCount > 0) UnloadModel(lods[level]);
+    lods[level] = model;
+
+    // 大きさは LOD0 (無ければ最初に届いたもの) で決める
+    if (level == 0 || localRadius == 0.0f)
+    {
+        localBounds = GetModelBoundingBox(model);
+        localRadius = Vector3Length(Vector3Subtract(localBounds.max, localBounds.min)) * 0.5f;
+    }
+}
+
+void LodModel::unload()
+{
+    // テクスチャとシェーダーは呼び出し側のもの (UnloadModel はどちらも解放しない)
+    for (Model& model : lods)
+    {
+        if (model.meshCount > 0) UnloadModel(model);
+    }
+    lods.clear();
+    batches.clear();
+    instances.clear();
+}
+
+int LodModel::addInstance(Vector3 position, float scale)
+{
+    instances.push_back({ position, scale, 0 });
+    return static_cast<int>(instances.size()) - 1;
+}
+
+int LodModel::selectLod(const Instance& instance, const Camera3D& camera) const
+{
+    // 画面の高さに対してどのくらいの大きさに映るか
+    float distance = Vector3Distance(instance.position, camera.position);
+    float halfHeight = distance * tanf(camera.fovy * 0.5f * DEG2RAD);
+    float screenSize = halfHeight > 0.0f ? (localRadius * instance.scale) / halfHeight : 1.0f;
+
+    int maxLod = static_cast<int>(lods.size()) - 1;
+    int lod = instance.lod;
+    // 粗くするのは境目を十分下回ってから、細かくするのは十分上回ってから
+    while (lod < maxLod && lod < static_cast<int>(lodScreenSizes.size()) &&
+           screenSize < lodScreenSizes[lod] * (1.0f - LOD_HYSTERESIS))
+    {
+        lod++;
+    }
+    while (lod > 0 && screenSize > lodScreenSizes[lod - 1] * (1.0f + LOD_HYSTERESIS))
+    {
+        lod--;
+    }
+    return lod;
+}
+
+int LodModel::nearestLoaded(int lod) const
+{
+    // 読み込み中の LOD の代わりに、いちばん近い読み込み済みの LOD を使う
+    int count = static_cast<int>(lods.size());
+    for (int offset = 0; offset < count; offset++)
+    {
+        if (lod + offset < count && lods[lod + offset].meshCount > 0) return lod + offset;
+        if (lod - offset >= 0 && lods[lod - offset].meshCount > 0) return lod - offset;
+    }
+    return -1;
+}
+
+void LodModel::draw(const Camera3D& camera, const Frustum& frustum, CullStats& stats)
+{
+    lastDrawCalls = 0;
+    lastTriangles = 0;
+    if (nearestLoaded(0) < 0) return;
+
+    for (std::vector<Matrix>& batch : batches) batch.clear();
+
+    for (Instance& instance : instances)
+    {
+        if (!stats.test(frustum, placeBox(localBounds, instance.position, instance.scale))) continue;
+
+        instance.lod = selectLod(instance, camera);
+        int lod = nearestLoaded(instance.lod);
+        // DrawModel と同じく 拡大 -> 移動 の順
+        Matrix transform = MatrixMultiply(MatrixScale(instance.scale, instance.scale, instance.scale),
+                                          MatrixTranslate(instance.position.x, instance.position.y, instance.position.z));
+        batches[lod].push_back(transform);
+    }
+
+    for (size_t lod = 0; lod < lods.size(); lod++)
+    {
+        const std::vector<Matrix>& batch = batches[lod];
+        if (batch.empty()) continue;
+
+        const Model& model = lods[lod];
+        for (int i = 0; i < model.meshCount; i++)
+        {
+            Material material = model.materials[model.meshMaterial[i]];
+            material.shader = shader;
+            DrawMeshInstanced(model.meshes[i], material, batch.data(), static_cast<int>(batch.size()));
+            lastDrawCalls++;
+            lastTriangles += model.meshes[i].triangleCount * static_cast<int>(batch.size());
+        }
+    }
+}
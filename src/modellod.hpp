@@ -0,0 +1,53 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <vector>
+
+#include "culling.hpp"
+
+// LOD0 (いちばん細かい) から順に並べたモデルを、インスタンスごとに切り替えて描く
+// 同じ LOD のインスタンスは DrawMeshInstanced でまとめて 1 回で描く
+class LodModel {
+public:
+    // 先に LOD の数などを決めて、読めたものから setLod で渡す (level 0 がいちばん細かい)
+    // instancingShader は resources/shaders/instancing.vs/fs
+    void init(int lodCount, Texture2D texture, Shader instancingShader);
+    void setLod(int level, Model model);
+    void unload();
+
+    // DrawModel と同じ位置・倍率の置き方。戻り値はインスタンス番号
+    int addInstance(Vector3 position, float scale);
+    int instanceCount() const { return static_cast<int>(instances.size()); }
+
+    // 画面に占める高さの割合がこれを下回ったら次の LOD へ (LOD 数 - 1 個)
+    void setLodScreenSizes(const std::vector<float>& sizes) { lodScreenSizes = sizes; }
+
+    // BeginMode3D の中で呼ぶ
+    void draw(const Camera3D& camera, const Frustum& frustum, CullStats& stats);
+
+    BoundingBox bounds() const { return localBounds; }
+    int drawCalls() const { return lastDrawCalls; }
+    int drawnTriangles() const { return lastTriangles; }
+
+private:
+    struct Instance {
+        Vector3 position;
+        float scale;
+        int lod;
+    };
+
+    int selectLod(const Instance& instance, const Camera3D& camera) const;
+    int nearestLoaded(int lod) const;
+
+    std::vector<Model> lods; // まだ読めていない LOD は meshCount が 0
+    std::vector<float> lodScreenSizes = { 0.15f, 0.05f };
+    std::vector<Instance> instances;
+    std::vector<std::vector<Matrix>> batches; // LOD ごとの行列 (毎フレーム使い回す)
+    Shader shader{};
+    Texture2D texture{};
+    BoundingBox localBounds = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    float localRadius = 0.0f;
+    int lastDrawCalls = 0;
+    int lastTriangles = 0;
+};
@@ -0,0 +1,247 @@
+#include "physics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PHYSICS_SSE 1
+#endif
+
+#include "blocks.hpp"
+
+namespace {
+
+constexpr float FAR_AWAY = 1e30f;
+// 接しているだけの箱は重なっていない扱いにする幅 (足元の床に横から引っかからないように)
+constexpr float SKIN = 1e-3f;
+
+} // namespace
+
+void AabbBatch::clear()
+{
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+    count = 0;
+}
+
+void AabbBatch::add(const Aabb& box)
+{
+    if (count == minX.size())
+    {
+        // 4 個ぶん、何とも重ならない箱 (min > max) で埋めておく
+        for (int i = 0; i < 4; i++)
+        {
+            minX.push_back(FAR_AWAY); minY.push_back(FAR_AWAY); minZ.push_back(FAR_AWAY);
+            maxX.push_back(-FAR_AWAY); maxY.push_back(-FAR_AWAY); maxZ.push_back(-FAR_AWAY);
+        }
+    }
+    minX[count] = box.minX; minY[count] = box.minY; minZ[count] = box.minZ;
+    maxX[count] = box.maxX; maxY[count] = box.maxY; maxZ[count] = box.maxZ;
+    count++;
+}
+
+Aabb AabbBatch::at(std::size_t i) const
+{
+    return { minX[i], minY[i], minZ[i], maxX[i], maxY[i], maxZ[i] };
+}
+
+void AabbBatch::overlapping(const Aabb& box, std::vector<int>& out) const
+{
+    const std::size_t padded = minX.size();
+#if PHYSICS_SSE
+    const __m128 bMinX = _mm_set1_ps(box.minX), bMaxX = _mm_set1_ps(box.maxX);
+    const __m128 bMinY = _mm_set1_ps(box.minY), bMaxY = _mm_set1_ps(box.maxY);
+    const __m128 bMinZ = _mm_set1_ps(box.minZ), bMaxZ = _mm_set1_ps(box.maxZ);
+    for (std::size_t i = 0; i < padded; i += 4)
+    {
+        __m128 hit = _mm_and_ps(_mm_cmplt_ps(bMinX, _mm_loadu_ps(&maxX[i])), _mm_cmpgt_ps(bMaxX, _mm_loadu_ps(&minX[i])));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmplt_ps(bMinY, _mm_loadu_ps(&maxY[i])), _mm_cmpgt_ps(bMaxY, _mm_loadu_ps(&minY[i]))));
+        hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmplt_ps(bMinZ, _mm_loadu_ps(&maxZ[i])), _mm_cmpgt_ps(bMaxZ, _mm_loadu_ps(&minZ[i]))));
+        int mask = _mm_movemask_ps(hit);
+        for (int k = 0; mask != 0; k++, mask >>= 1)
+        {
+            if (mask & 1) out.push_back(static_cast<int>(i) + k);
+        }
+    }
+#else
+    for (std::size_t i = 0; i < padded; i++)
+    {
+        if (box.minX < maxX[i] && box.maxX > minX[i] && box.minY < maxY[i] && box.maxY > minY[i] &&
+            box.minZ < maxZ[i] && box.maxZ > minZ[i])
+        {
+            out.push_back(static_cast<int>(i));
+        }
+    }
+#endif
+}
+
+float AabbBatch::sweep(const Aabb& box, int axis, float delta) const
+{
+    if (delta == 0.0f || count == 0) return delta;
+
+    // 動かす軸と残りの 2 軸に並べ替える
+    const float boxMin[3] = { box.minX, box.minY, box.minZ };
+    const float boxMax[3] = { box.maxX, box.maxY, box.maxZ };
+    const std::vector<float>* mins[3] = { &minX, &minY, &minZ };
+    const std::vector<float>* maxs[3] = { &maxX, &maxY, &maxZ };
+    const int a1 = (axis + 1) % 3;
+    const int a2 = (axis + 2) % 3;
+
+    // 進む向きの面と、相手のこちらを向いた面の距離。負 (めり込んでいる) のものは無視
+    const bool positive = delta > 0.0f;
+    const float face = positive ? boxMax[axis] : boxMin[axis];
+    const float sign = positive ? 1.0f : -1.0f;
+    const float* facing = positive ? mins[axis]->data() : maxs[axis]->data();
+    const float* min1 = mins[a1]->data();
+    const float* max1 = maxs[a1]->data();
+    const float* min2 = mins[a2]->data();
+    const float* max2 = maxs[a2]->data();
+    const float lo1 = boxMin[a1] + SKIN, hi1 = boxMax[a1] - SKIN;
+    const float lo2 = boxMin[a2] + SKIN, hi2 = boxMax[a2] - SKIN;
+
+    float limit = std::fabs(delta);
+    const std::size_t padded = minX.size();
+#if PHYSICS_SSE
+    const __m128 vLo1 = _mm_set1_ps(lo1), vHi1 = _mm_set1_ps(hi1);
+    const __m128 vLo2 = _mm_set1_ps(lo2), vHi2 = _mm_set1_ps(hi2);
+    const __m128 vFace = _mm_set1_ps(face);
+    const __m128 vSign = _mm_set1_ps(sign);
+    const __m128 vSkin = _mm_set1_ps(-SKIN);
+    __m128 vLimit = _mm_set1_ps(limit);
+    for (std::size_t i = 0; i < padded; i += 4)
+    {
+        __m128 inside = _mm_and_ps(_mm_cmplt_ps(vLo1, _mm_loadu_ps(max1 + i)), _mm_cmpgt_ps(vHi1, _mm_loadu_ps(min1 + i)));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(vLo2, _mm_loadu_ps(max2 + i)), _mm_cmpgt_ps(vHi2, _mm_loadu_ps(min2 + i))));
+        __m128 distance = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(facing + i), vFace), vSign);
+        __m128 valid = _mm_and_ps(inside, _mm_cmpge_ps(distance, vSkin));
+        // 対象外のところは今の limit のままにして min を取る
+        __m128 candidate = _mm_or_ps(_mm_and_ps(valid, distance), _mm_andnot_ps(valid, vLimit));
+        vLimit = _mm_min_ps(vLimit, candidate);
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, vLimit);
+    limit = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+#else
+    for (std::size_t i = 0; i < padded; i++)
+    {
+        if (!(lo1 < max1[i] && hi1 > min1[i] && lo2 < max2[i] && hi2 > min2[i])) continue;
+        float distance = (facing[i] - face) * sign;
+        if (distance >= -SKIN) limit = std::min(limit, distance);
+    }
+#endif
+    limit = std::max(limit, 0.0f);
+    return positive ? limit : -limit;
+}
+
+void Physics::setStaticColliders(const std::vector<Aabb>& boxes)
+{
+    statics.clear();
+    for (const Aabb& box : boxes) statics.add(box);
+}
+
+void Physics::setRequiredChunkRange(int minChunkY, int maxChunkY)
+{
+    requiredMinChunkY = minChunkY;
+    requiredMaxChunkY = maxChunkY;
+}
+
+void Physics::step(const World& world, PhysicsBody* bodies, std::size_t count, float dt)
+{
+    lastTested = 0;
+    for (std::size_t i = 0; i < count; i++) moveBody(world, bodies[i], dt);
+}
+
+bool Physics::gatherVoxels(const World& world, const Aabb& swept)
+{
+    const int x0 = static_cast<int>(std::floor(swept.minX)), x1 = static_cast<int>(std::floor(swept.maxX));
+    const int y0 = static_cast<int>(std::floor(swept.minY)), y1 = static_cast<int>(std::floor(swept.maxY));
+    const int z0 = static_cast<int>(std::floor(swept.minZ)), z1 = static_cast<int>(std::floor(swept.maxZ));
+    const BlockRegistry& registry = blockRegistry();
+
+    // チャンクごとにまとめて引く
+    const ChunkCoord first = chunkCoordOf(x0, y0, z0);
+    const ChunkCoord last = chunkCoordOf(x1, y1, z1);
+    for (int cy = first.y; cy <= last.y; cy++)
+    for (int cz = first.z; cz <= last.z; cz++)
+    for (int cx = first.x; cx <= last.x; cx++)
+    {
+        const ChunkCoord coord = { cx, cy, cz };
+        const Chunk* chunk = world.findLoadedChunk(coord);
+        if (!chunk)
+        {
+            if (cy >= requiredMinChunkY && cy <= requiredMaxChunkY) return false;
+            continue;
+        }
+        if (chunk->empty()) continue;
+
+        const int baseX = cx * CHUNK_SIZE, baseY = cy * CHUNK_SIZE, baseZ = cz * CHUNK_SIZE;
+        const int lx0 = std::max(x0 - baseX, 0), lx1 = std::min(x1 - baseX, CHUNK_SIZE - 1);
+        const int ly0 = std::max(y0 - baseY, 0), ly1 = std::min(y1 - baseY, CHUNK_SIZE - 1);
+        const int lz0 = std::max(z0 - baseZ, 0), lz1 = std::min(z1 - baseZ, CHUNK_SIZE - 1);
+        for (int ly = ly0; ly <= ly1; ly++)
+        for (int lz = lz0; lz <= lz1; lz++)
+        for (int lx = lx0; lx <= lx1; lx++)
+        {
+            BlockId type = chunk->get(lx, ly, lz);
+            if (type == BLOCK_AIR || !registry.isSolid(type)) continue;
+            float x = static_cast<float>(baseX + lx);
+            float y = static_cast<float>(baseY + ly);
+            float z = static_cast<float>(baseZ + lz);
+            obstacles.add({ x, y, z, x + 1.0f, y + 1.0f, z + 1.0f });
+        }
+    }
+    return true;
+}
+
+void Physics::moveBody(const World& world, PhysicsBody& body, float dt)
+{
+    if (body.gravity) body.velocityY = std::max(body.velocityY - GRAVITY * dt, -MAX_FALL_SPEED);
+    body.velocityX = std::clamp(body.velocityX, -MAX_SPEED, MAX_SPEED);
+    body.velocityY = std::clamp(body.velocityY, -MAX_SPEED, MAX_SPEED);
+    body.velocityZ = std::clamp(body.velocityZ, -MAX_SPEED, MAX_SPEED);
+    const float dx = body.velocityX * dt;
+    const float dy = body.velocityY * dt;
+    const float dz = body.velocityZ * dt;
+
+    // この tick で通る範囲 (今の箱と動いた先の箱を囲む箱)
+    Aabb box = body.bounds();
+    const Aabb swept = {
+        std::min(box.minX, box.minX + dx), std::min(box.minY, box.minY + dy), std::min(box.minZ, box.minZ + dz),
+        std::max(box.maxX, box.maxX + dx), std::max(box.maxY, box.maxY + dy), std::max(box.maxZ, box.maxZ + dz),
+    };
+
+    obstacles.clear();
+    body.waiting = !gatherVoxels(world, swept);
+    if (body.waiting)
+    {
+        // 足元がまだできていない。落ちていかないように止めておく
+        body.velocityY = 0.0f;
+        body.onGround = false;
+        return;
+    }
+    // 置き物はまず外接箱で通る範囲と重なるものだけに絞る
+    staticHits.clear();
+    statics.overlapping(swept, staticHits);
+    for (int i : staticHits) obstacles.add(statics.at(i));
+    lastTested += obstacles.size();
+
+    // 縦、横の順に 1 軸ずつ動かして、ぶつかったらそこで止める
+    const float moveY = obstacles.sweep(box, 1, dy);
+    box.minY += moveY;
+    box.maxY += moveY;
+    body.onGround = dy < 0.0f && moveY > dy;
+    if (moveY != dy) body.velocityY = 0.0f;
+
+    const float moveX = obstacles.sweep(box, 0, dx);
+    box.minX += moveX;
+    box.maxX += moveX;
+    if (moveX != dx) body.velocityX = 0.0f;
+
+    const float moveZ = obstacles.sweep(box, 2, dz);
+    if (moveZ != dz) body.velocityZ = 0.0f;
+
+    body.x += moveX;
+    body.y += moveY;
+    body.z += moveZ;
+}
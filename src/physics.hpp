@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "world.hpp"
+
+// 軸に沿った箱 (ワールド座標)
+struct Aabb {
+    float minX;
+    float minY;
+    float minZ;
+    float maxX;
+    float maxY;
+    float maxZ;
+
+    bool overlaps(const Aabb& other) const
+    {
+        return minX < other.maxX && maxX > other.minX && minY < other.maxY && maxY > other.minY &&
+               minZ < other.maxZ && maxZ > other.minZ;
+    }
+};
+
+// 箱をまとめて判定するための入れ物 (軸ごとに配列を分けて持つ)
+// SSE があれば 4 個ずつ調べる。末尾は何とも重ならない箱で 4 の倍数に埋めてある
+class AabbBatch {
+public:
+    void clear();
+    void add(const Aabb& box);
+    std::size_t size() const { return count; }
+    Aabb at(std::size_t i) const;
+
+    // box と重なっているものの番号を out に足す
+    void overlapping(const Aabb& box, std::vector<int>& out) const;
+
+    // box を axis (0:x 1:y 2:z) に delta だけ動かしたとき、どれにもめり込まずに動ける量
+    // 最初から重なっているものは無視する (めり込んだら抜け出せるように)
+    float sweep(const Aabb& box, int axis, float delta) const;
+
+private:
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    std::size_t count = 0;
+};
+
+// 重力と当たり判定で動くもの。位置は足元の中心
+struct PhysicsBody {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+    float velocityX = 0.0f;
+    float velocityY = 0.0f;
+    float velocityZ = 0.0f;
+    float halfWidth = 0.3f;
+    float height = 1.8f;
+    bool gravity = true;
+    bool onGround = false;
+    bool waiting = false; // 周りのチャンクがまだ無いので止めている
+
+    Aabb bounds() const { return { x - halfWidth, y, z - halfWidth, x + halfWidth, y + height, z + halfWidth }; }
+};
+
+// ボクセルと置き物 (モデルなどの外接箱) に対する当たり判定
+// 1 体ごとに、その tick で通る範囲のボクセルと置き物だけを集めて、まとめて押し戻す
+// 速さに上限があるので、1 体にかかる手間は数が増えても一定
+class Physics {
+public:
+    static constexpr float GRAVITY = 25.0f;          // ブロック/秒^2
+    static constexpr float MAX_FALL_SPEED = 40.0f;   // ブロック/秒
+    static constexpr float MAX_SPEED = 60.0f;        // 1 軸あたり (通る範囲が広がりすぎないように)
+
+    // 動かない箱を差し替える
+    void setStaticColliders(const std::vector<Aabb>& boxes);
+    // この高さ (チャンク単位) のチャンクが無いところでは、読み込まれるまで体を止めておく
+    // 地形のある範囲を渡す。それ以外の無いチャンクは空気として扱う
+    void setRequiredChunkRange(int minChunkY, int maxChunkY);
+
+    // world はこの間書き換えないこと (別スレッドなら world.mutex() を shared で持つ)
+    void step(const World& world, PhysicsBody* bodies, std::size_t count, float dt);
+    void step(const World& world, PhysicsBody& body, float dt) { step(world, &body, 1, dt); }
+
+    // 直前の step で調べた箱の数 (ボクセル + 置き物)
+    std::size_t testedBoxes() const { return lastTested; }
+
+private:
+    // 通る範囲のボクセルを obstacles に集める。チャンクがまだ無ければ false
+    bool gatherVoxels(const World& world, const Aabb& swept);
+    void moveBody(const World& world, PhysicsBody& body, float dt);
+
+    AabbBatch statics;
+    AabbBatch obstacles;          // 1 体ぶんの作業用 (使い回す)
+    std::vector<int> staticHits;  // 同上
+    std::size_t lastTested = 0;
+    int requiredMinChunkY = 0;
+    int requiredMaxChunkY = -1; // 空 (待たない)
+};
@@ -0,0 +1,200 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+namespace {
+
+std::uint64_t steadyNs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// スレッドごとの小さい番号 (最初に記録したスレッドから 1, 2, ...)
+std::uint32_t threadNumber()
+{
+    static std::atomic<std::uint32_t> next{ 1 };
+    thread_local std::uint32_t number = next.fetch_add(1);
+    return number;
+}
+
+} // namespace
+
+Profiler& profiler()
+{
+    static Profiler instance;
+    return instance;
+}
+
+Profiler::Profiler() : epochNs(steadyNs()) {}
+
+std::uint64_t Profiler::now() const
+{
+    return steadyNs() - epochNs;
+}
+
+void Profiler::record(const char* name, std::uint64_t startNs, std::uint64_t endNs)
+{
+    std::uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Event& e = events[index % EVENT_CAPACITY];
+    e.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.name.store(name, std::memory_order_relaxed);
+    e.startNs.store(startNs, std::memory_order_relaxed);
+    e.endNs.store(endNs, std::memory_order_relaxed);
+    e.frame.store(currentFrame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    e.thread.store(threadNumber(), std::memory_order_relaxed);
+    e.sequence.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::beginFrame()
+{
+    frameStartNs = now();
+}
+
+void Profiler::endFrame(int drawCalls, int triangles)
+{
+    Frame& frame = frames[framesRecorded % FRAME_CAPACITY];
+    frame.startNs = frameStartNs;
+    frame.endNs = now();
+    frame.drawCalls = drawCalls;
+    frame.triangles = triangles;
+    drawCallsLast = drawCalls;
+    trianglesLast = triangles;
+    framesRecorded++;
+    currentFrame.store(framesRecorded, std::memory_order_relaxed);
+}
+
+std::vector<float> Profiler::frameTimes(int lastFrames) const
+{
+    int count = std::min<int>({ lastFrames, FRAME_CAPACITY, static_cast<int>(framesRecorded) });
+    std::vector<float> times;
+    times.reserve(count);
+    for (std::uint32_t f = framesRecorded - count; f < framesRecorded; f++)
+    {
+        const Frame& frame = frames[f % FRAME_CAPACITY];
+        times.push_back(static_cast<float>((frame.endNs - frame.startNs) * 1e-6));
+    }
+    return times;
+}
+
+Profiler::FrameStats Profiler::frameStats(int lastFrames) const
+{
+    FrameStats stats;
+    std::vector<float> times = frameTimes(lastFrames);
+    if (times.empty()) return stats;
+
+    double total = 0.0;
+    for (float t : times) total += t;
+    std::sort(times.begin(), times.end());
+    stats.frames = static_cast<int>(times.size());
+    stats.minMs = times.front();
+    stats.maxMs = times.back();
+    stats.avgMs = total / times.size();
+    stats.p99Ms = times[static_cast<size_t>(0.99 * (times.size() - 1) + 0.5)];
+    return stats;
+}
+
+std::vector<Profiler::EventCopy> Profiler::snapshot(std::uint32_t firstFrame) const
+{
+    std::vector<EventCopy> copies;
+    std::uint64_t end = writeIndex.load(std::memory_order_acquire);
+    std::uint64_t begin = end > EVENT_CAPACITY ? end - EVENT_CAPACITY : 0;
+    copies.reserve(static_cast<size_t>(end - begin));
+    for (std::uint64_t index = begin; index < end; index++)
+    {
+        const Event& e = events[index % EVENT_CAPACITY];
+        std::uint64_t before = e.sequence.load(std::memory_order_acquire);
+        if (before != index + 1) continue; // まだ書いている / もう上書きされた
+        EventCopy copy = {
+            e.name.load(std::memory_order_relaxed),
+            e.startNs.load(std::memory_order_relaxed),
+            e.endNs.load(std::memory_order_relaxed),
+            e.frame.load(std::memory_order_relaxed),
+            e.thread.load(std::memory_order_relaxed),
+        };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.sequence.load(std::memory_order_relaxed) != before) continue;
+        if (copy.frame >= firstFrame) copies.push_back(copy);
+    }
+    return copies;
+}
+
+bool Profiler::exportChromeTrace(const std::string& path, int lastFrames) const
+{
+    std::uint32_t count = std::min<std::uint32_t>({ static_cast<std::uint32_t>(lastFrames),
+                                                    static_cast<std::uint32_t>(FRAME_CAPACITY), framesRecorded });
+    std::uint32_t firstFrame = framesRecorded - count;
+
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "ファイルを開けませんでした: " << path << std::endl;
+        return false;
+    }
+
+    // 時間の単位はマイクロ秒
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+    char line[256];
+    for (std::uint32_t f = firstFrame; f < framesRecorded; f++)
+    {
+        const Frame& frame = frames[f % FRAME_CAPACITY];
+        std::snprintf(line, sizeof(line),
+                      "%s{\"name\":\"frame %u\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":0,"
+                      "\"args\":{\"drawCalls\":%d,\"triangles\":%d}}",
+                      first ? "" : ",\n", f, frame.startNs * 1e-3, (frame.endNs - frame.startNs) * 1e-3,
+                      frame.drawCalls, frame.triangles);
+        file << line;
+        first = false;
+    }
+    for (const EventCopy& e : snapshot(firstFrame))
+    {
+        std::snprintf(line, sizeof(line),
+                      "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                      first ? "" : ",\n", e.name, e.startNs * 1e-3, (e.endNs - e.startNs) * 1e-3, e.thread);
+        file << line;
+        first = false;
+    }
+    file << "\n]}\n";
+    return true;
+}
+
+bool Profiler::exportCsv(const std::string& path, int lastFrames) const
+{
+    std::uint32_t count = std::min<std::uint32_t>({ static_cast<std::uint32_t>(lastFrames),
+                                                    static_cast<std::uint32_t>(FRAME_CAPACITY), framesRecorded });
+    std::uint32_t firstFrame = framesRecorded - count;
+
+    // フレームごと・区間ごとの合計 (ms)
+    std::vector<EventCopy> copies = snapshot(firstFrame);
+    std::map<std::string, std::map<std::uint32_t, double>> totals;
+    for (const EventCopy& e : copies) totals[e.name][e.frame] += (e.endNs - e.startNs) * 1e-6;
+
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        std::cerr << "ファイルを開けませんでした: " << path << std::endl;
+        return false;
+    }
+    file << "frame,frame_ms,draw_calls,triangles";
+    for (const auto& column : totals) file << "," << column.first << "_ms";
+    file << "\n";
+    for (std::uint32_t f = firstFrame; f < framesRecorded; f++)
+    {
+        const Frame& frame = frames[f % FRAME_CAPACITY];
+        file << f << "," << (frame.endNs - frame.startNs) * 1e-6 << "," << frame.drawCalls << "," << frame.triangles;
+        for (const auto& column : totals)
+        {
+            auto it = column.second.find(f);
+            file << "," << (it == column.second.end() ? 0.0 : it->second);
+        }
+        file << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// フレームごとの区間計測 (DevelopMode 用)
+//   PROFILE_SCOPE("render"); と書くと、そのスコープを抜けるまでの時間を記録する
+// 記録はどのスレッドからでもロック無しでリングバッファに書ける
+class Profiler {
+public:
+    static constexpr int EVENT_CAPACITY = 1 << 14;
+    static constexpr int FRAME_CAPACITY = 240;
+
+    struct FrameStats {
+        double minMs = 0.0;
+        double avgMs = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+        int frames = 0;
+    };
+
+    Profiler();
+
+    // 起動からのナノ秒
+    std::uint64_t now() const;
+
+    // name は文字列リテラルなど、ずっと残るものを渡す
+    void record(const char* name, std::uint64_t startNs, std::uint64_t endNs);
+
+    // メインスレッドからフレームの始めと終わりに呼ぶ
+    void beginFrame();
+    void endFrame(int drawCalls, int triangles);
+
+    FrameStats frameStats(int lastFrames = FRAME_CAPACITY) const;
+    // 古い順に lastFrames 個のフレーム時間 (ms)
+    std::vector<float> frameTimes(int lastFrames = FRAME_CAPACITY) const;
+    int lastDrawCalls() const { return drawCallsLast; }
+    int lastTriangles() const { return trianglesLast; }
+
+    // 直近 lastFrames フレームぶんを書き出す (chrome://tracing や Perfetto で開ける)
+    bool exportChromeTrace(const std::string& path, int lastFrames) const;
+    // フレーム番号, フレーム時間, 描画回数, 三角形数 と区間ごとの合計時間
+    bool exportCsv(const std::string& path, int lastFrames) const;
+
+private:
+    // 書いている途中は sequence が 0、書き終わったら書き込み番号 + 1 (seqlock)
+    struct Event {
+        std::atomic<std::uint64_t> sequence{ 0 };
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<std::uint64_t> startNs{ 0 };
+        std::atomic<std::uint64_t> endNs{ 0 };
+        std::atomic<std::uint32_t> frame{ 0 };
+        std::atomic<std::uint32_t> thread{ 0 };
+    };
+
+    struct EventCopy {
+        const char* name;
+        std::uint64_t startNs;
+        std::uint64_t endNs;
+        std::uint32_t frame;
+        std::uint32_t thread;
+    };
+
+    struct Frame {
+        std::uint64_t startNs = 0;
+        std::uint64_t endNs = 0;
+        int drawCalls = 0;
+        int triangles = 0;
+    };
+
+    // 書き換え途中のものは飛ばしてコピーする
+    std::vector<EventCopy> snapshot(std::uint32_t firstFrame) const;
+
+    std::uint64_t epochNs;
+    std::array<Event, EVENT_CAPACITY> events;
+    std::atomic<std::uint64_t> writeIndex{ 0 };
+    std::atomic<std::uint32_t> currentFrame{ 0 };
+
+    // フレームの記録はメインスレッドだけが触る
+    std::array<Frame, FRAME_CAPACITY> frames;
+    std::uint64_t frameStartNs = 0;
+    std::uint32_t framesRecorded = 0;
+    int drawCallsLast = 0;
+    int trianglesLast = 0;
+};
+
+Profiler& profiler();
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name) : name(name), start(profiler().now()) {}
+    ~ProfileScope() { profiler().record(name, start, profiler().now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    std::uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
@@ -0,0 +1,45 @@
+#include "profilerhud.hpp"
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+constexpr int GRAPH_FRAMES = 120;
+constexpr int GRAPH_HEIGHT = 60;
+constexpr float GRAPH_MAX_MS = 66.7f;    // これ以上は頭打ち
+constexpr int UNCAPPED_BUDGET_FPS = 60;  // --fps 0 (上限なし) のときの予算
+
+} // namespace
+
+void drawProfilerOverlay(const Profiler& profiler, int x, int y, int targetFps)
+{
+    const float frameBudgetMs = 1000.0f / static_cast<float>(targetFps > 0 ? targetFps : UNCAPPED_BUDGET_FPS);
+    std::vector<float> times = profiler.frameTimes(GRAPH_FRAMES);
+    Profiler::FrameStats stats = profiler.frameStats();
+
+    const int barWidth = 2;
+    const int width = GRAPH_FRAMES * barWidth;
+    DrawRectangle(x, y, width, GRAPH_HEIGHT, Fade(BLACK, 0.5f));
+
+    // 1 フレーム 1 本の棒。予算を超えたフレームは赤
+    int offset = GRAPH_FRAMES - static_cast<int>(times.size());
+    for (size_t i = 0; i < times.size(); i++)
+    {
+        float ms = times[i] < GRAPH_MAX_MS ? times[i] : GRAPH_MAX_MS;
+        int h = static_cast<int>(ms / GRAPH_MAX_MS * GRAPH_HEIGHT);
+        Color color = times[i] > frameBudgetMs ? RED : LIME;
+        DrawRectangle(x + (offset + static_cast<int>(i)) * barWidth, y + GRAPH_HEIGHT - h, barWidth, h, color);
+    }
+    int budgetY = y + GRAPH_HEIGHT - static_cast<int>(std::min(frameBudgetMs, GRAPH_MAX_MS) / GRAPH_MAX_MS * GRAPH_HEIGHT);
+    DrawLine(x, budgetY, x + width, budgetY, YELLOW);
+
+    DrawText(TextFormat("frame ms  min %.1f  avg %.1f  p99 %.1f  max %.1f",
+                        stats.minMs, stats.avgMs, stats.p99Ms, stats.maxMs),
+             x, y + GRAPH_HEIGHT + 4, 10, DARKGRAY);
+    DrawText(TextFormat("draw calls %d  triangles %d", profiler.lastDrawCalls(), profiler.lastTriangles()),
+             x, y + GRAPH_HEIGHT + 16, 10, DARKGRAY);
+    DrawText("F6: profile_trace.json / profile_frames.csv", x, y + GRAPH_HEIGHT + 28, 10, DARKGRAY);
+}
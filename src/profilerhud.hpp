@@ -0,0 +1,7 @@
+#pragma once
+
+#include "profiler.hpp"
+
+// フレーム時間のグラフと min/avg/p99、描画回数、三角形数を (x, y) から描く
+// targetFps (SetTargetFPS と同じ値) の 1 フレームを予算として、超えたフレームを赤くする。0 なら 60 FPS とみなす
+void drawProfilerOverlay(const Profiler& profiler, int x, int y, int targetFps);
@@ -0,0 +1,114 @@
+#include "raycast.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 直前に引いたチャンクを覚えておいて、同じチャンクの中ならハッシュを引かない
+class ChunkCursor {
+public:
+    explicit ChunkCursor(const World& world) : world(world) {}
+
+    BlockId get(int x, int y, int z)
+    {
+        ChunkCoord coord = chunkCoordOf(x, y, z);
+        if (!valid || coord != current)
+        {
+            current = coord;
+            chunk = world.findLoadedChunk(coord);
+            valid = true;
+        }
+        if (!chunk || chunk->empty()) return BLOCK_AIR;
+        return chunk->get(floorMod(x, CHUNK_SIZE), floorMod(y, CHUNK_SIZE), floorMod(z, CHUNK_SIZE));
+    }
+
+private:
+    const World& world;
+    ChunkCoord current{ 0, 0, 0 };
+    const Chunk* chunk = nullptr;
+    bool valid = false;
+};
+
+RayHit traverse(ChunkCursor& cursor, const VoxelRay& ray)
+{
+    RayHit result;
+    const float origin[3] = { ray.originX, ray.originY, ray.originZ };
+    float direction[3] = { ray.directionX, ray.directionY, ray.directionZ };
+    float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (length == 0.0f || !std::isfinite(ray.maxDistance)) return result;
+
+    int voxel[3];
+    int step[3];
+    float tMax[3];   // 次にその軸の境界をまたぐまでの距離
+    float tDelta[3]; // その軸で 1 ブロック進むのにかかる距離
+    const float infinity = std::numeric_limits<float>::infinity();
+    for (int i = 0; i < 3; i++)
+    {
+        direction[i] /= length;
+        voxel[i] = static_cast<int>(std::floor(origin[i]));
+        if (direction[i] > 0.0f)
+        {
+            step[i] = 1;
+            tDelta[i] = 1.0f / direction[i];
+            tMax[i] = (voxel[i] + 1 - origin[i]) * tDelta[i];
+        }
+        else if (direction[i] < 0.0f)
+        {
+            step[i] = -1;
+            tDelta[i] = -1.0f / direction[i];
+            tMax[i] = (origin[i] - voxel[i]) * tDelta[i];
+        }
+        else
+        {
+            step[i] = 0;
+            tDelta[i] = infinity;
+            tMax[i] = infinity;
+        }
+    }
+
+    // 始点がブロックの中
+    BlockId type = cursor.get(voxel[0], voxel[1], voxel[2]);
+    int normal[3] = { 0, 0, 0 };
+    float distance = 0.0f;
+    while (type == BLOCK_AIR)
+    {
+        int axis = 0;
+        if (tMax[1] < tMax[axis]) axis = 1;
+        if (tMax[2] < tMax[axis]) axis = 2;
+        distance = tMax[axis];
+        if (distance > ray.maxDistance) return result;
+
+        voxel[axis] += step[axis];
+        tMax[axis] += tDelta[axis];
+        normal[0] = normal[1] = normal[2] = 0;
+        normal[axis] = -step[axis];
+        type = cursor.get(voxel[0], voxel[1], voxel[2]);
+    }
+
+    result.hit = true;
+    result.x = voxel[0];
+    result.y = voxel[1];
+    result.z = voxel[2];
+    result.type = type;
+    result.normalX = normal[0];
+    result.normalY = normal[1];
+    result.normalZ = normal[2];
+    result.distance = distance;
+    return result;
+}
+
+} // namespace
+
+RayHit raycastVoxels(const World& world, const VoxelRay& ray)
+{
+    ChunkCursor cursor(world);
+    return traverse(cursor, ray);
+}
+
+void raycastVoxels(const World& world, const std::vector<VoxelRay>& rays, std::vector<RayHit>& hits)
+{
+    ChunkCursor cursor(world);
+    hits.resize(rays.size());
+    for (size_t i = 0; i < rays.size(); i++) hits[i] = traverse(cursor, rays[i]);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include "world.hpp"
+
+// ブロック単位で進む光線 (方向は正規化しなくてよい。maxDistance は有限の値で)
+struct VoxelRay {
+    float originX;
+    float originY;
+    float originZ;
+    float directionX;
+    float directionY;
+    float directionZ;
+    float maxDistance;
+};
+
+struct RayHit {
+    bool hit = false;
+    // 当たったブロック
+    int x = 0;
+    int y = 0;
+    int z = 0;
+    BlockId type = BLOCK_AIR;
+    // 当たった面の向き (ブロックを置くなら (x, y, z) + normal)。始点がブロックの中なら 0
+    int normalX = 0;
+    int normalY = 0;
+    int normalZ = 0;
+    // 始点から当たった面までの距離
+    float distance = 0.0f;
+};
+
+// 光線が通るブロックを近い順に 1 つずつ調べる (3D DDA)
+// 調べるのは読み込み済みのチャンクだけ。ファイルから読み込んだりはしない
+RayHit raycastVoxels(const World& world, const VoxelRay& ray);
+// たくさんの光線をまとめて (視線チェックや光のサンプルなど)。最後に引いたチャンクは光線の間でも使い回す
+void raycastVoxels(const World& world, const std::vector<VoxelRay>& rays, std::vector<RayHit>& hits);
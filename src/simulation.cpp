@@ -0,0 +1,193 @@
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <shared_mutex>
+
+#include "profiler.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float PITCH_LIMIT = 1.5607963f; // PI/2 - 0.01
+
+std::uint64_t steadyNs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now().time_since_epoch()).count());
+}
+
+float lerp(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+} // namespace
+
+void stepPlayer(PlayerState& player, PhysicsBody& body, const PlayerInput& input)
+{
+    // マウスの移動量は溜まった分をそのまま使う (フレームレートに依らない)
+    player.yaw -= input.lookX * MOUSE_SENSITIVITY;
+    player.pitch -= input.lookY * MOUSE_SENSITIVITY;
+    player.pitch = std::clamp(player.pitch, -PITCH_LIMIT, PITCH_LIMIT);
+
+    float forwardX = std::sin(player.yaw);
+    float forwardZ = std::cos(player.yaw);
+    float rightX = std::cos(player.yaw);
+    float rightZ = -std::sin(player.yaw);
+
+    float moveX = 0.0f;
+    float moveZ = 0.0f;
+    if (input.forward) { moveX += forwardX; moveZ += forwardZ; }
+    if (input.back) { moveX -= forwardX; moveZ -= forwardZ; }
+    if (input.left) { moveX += rightX; moveZ += rightZ; }
+    if (input.right) { moveX -= rightX; moveZ -= rightZ; }
+    body.velocityX = moveX * PLAYER_SPEED;
+    body.velocityZ = moveZ * PLAYER_SPEED;
+
+    body.gravity = !input.fly;
+    if (input.fly)
+    {
+        body.velocityY = 0.0f;
+        if (input.up) body.velocityY += PLAYER_SPEED;
+        if (input.down) body.velocityY -= PLAYER_SPEED;
+    }
+    else if (input.up && body.onGround)
+    {
+        body.velocityY = PLAYER_JUMP_SPEED;
+    }
+}
+
+Simulation::Simulation(const PlayerState& initial, const World& world) : player(initial), world(world)
+{
+    PhysicsBody body;
+    body.x = initial.x;
+    body.y = initial.y;
+    body.z = initial.z;
+    bodies.push_back(body);
+    buffers[0] = { initial, initial, steadyNs() };
+    buffers[1] = buffers[0];
+}
+
+Simulation::~Simulation()
+{
+    stop();
+}
+
+void Simulation::start()
+{
+    if (running.exchange(true)) return;
+    thread = std::thread(&Simulation::run, this);
+}
+
+void Simulation::stop()
+{
+    if (!running.exchange(false)) return;
+    if (thread.joinable()) thread.join();
+}
+
+void Simulation::addInput(const PlayerInput& input)
+{
+    std::lock_guard<std::mutex> lock(inputMutex);
+    float lookX = pendingInput.lookX + input.lookX;
+    float lookY = pendingInput.lookY + input.lookY;
+    pendingInput = input;
+    pendingInput.lookX = lookX;
+    pendingInput.lookY = lookY;
+}
+
+PlayerState Simulation::latest() const
+{
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    return front->current;
+}
+
+PlayerState Simulation::interpolated() const
+{
+    Snapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        snapshot = *front;
+    }
+    // current ができてからの経過時間で previous -> current を補間する (1 tick 遅れて表示)
+    const double tickNs = 1e9 / TICKS_PER_SECOND;
+    std::uint64_t now = steadyNs();
+    double elapsed = now > snapshot.timeNs ? static_cast<double>(now - snapshot.timeNs) : 0.0;
+    float t = static_cast<float>(std::min(1.0, elapsed / tickNs));
+
+    const PlayerState& a = snapshot.previous;
+    const PlayerState& b = snapshot.current;
+    return {
+        lerp(a.x, b.x, t),
+        lerp(a.y, b.y, t),
+        lerp(a.z, b.z, t),
+        lerp(a.yaw, b.yaw, t),
+        lerp(a.pitch, b.pitch, t),
+    };
+}
+
+void Simulation::setStaticColliders(const std::vector<Aabb>& boxes)
+{
+    std::lock_guard<std::mutex> lock(inputMutex);
+    pendingColliders = boxes;
+    collidersChanged = true;
+}
+
+void Simulation::run()
+{
+    const auto tickDuration = std::chrono::nanoseconds(1000000000 / TICKS_PER_SECOND);
+    Clock::time_point nextTick = Clock::now() + tickDuration;
+    while (running.load())
+    {
+        std::this_thread::sleep_until(nextTick);
+
+        // 遅れた分は追いつくまで続けて回す。遅れすぎたら捨てる
+        int steps = 0;
+        Clock::time_point now = Clock::now();
+        while (nextTick <= now && steps < MAX_CATCH_UP_TICKS)
+        {
+            tick();
+            nextTick += tickDuration;
+            steps++;
+        }
+        if (nextTick <= now) nextTick = now + tickDuration;
+    }
+}
+
+void Simulation::tick()
+{
+    PROFILE_SCOPE("simulation");
+    PlayerInput input;
+    {
+        std::lock_guard<std::mutex> lock(inputMutex);
+        input = pendingInput;
+        pendingInput.lookX = 0.0f;
+        pendingInput.lookY = 0.0f;
+        if (collidersChanged)
+        {
+            physics.setStaticColliders(pendingColliders);
+            collidersChanged = false;
+        }
+    }
+
+    PlayerState previous = player;
+    PhysicsBody& body = bodies[0];
+    stepPlayer(player, body, input);
+    {
+        // メインスレッドがチャンクを入れたり書き換えたりしている間は待つ
+        // 結果を渡すまでロックを持っておく (world.mutex() を unique で持てば latest は最新の tick)
+        std::shared_lock<std::shared_mutex> lock(world.mutex());
+        physics.step(world, bodies.data(), bodies.size(), 1.0f / TICKS_PER_SECOND);
+        player.x = body.x;
+        player.y = body.y;
+        player.z = body.z;
+
+        *back = { previous, player, steadyNs() };
+        {
+            std::lock_guard<std::mutex> snapshotLock(snapshotMutex);
+            std::swap(front, back);
+        }
+    }
+}
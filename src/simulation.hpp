@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "physics.hpp"
+#include "world.hpp"
+
+// プレイヤーの足元の位置と向き (ラジアン)
+struct PlayerState {
+    float x;
+    float y;
+    float z;
+    float yaw;   // 水平回転
+    float pitch; // 垂直回転
+};
+
+// メインスレッドで集めた入力。キーは最新の状態、マウスの移動量は次の tick まで溜める
+struct PlayerInput {
+    bool forward = false;
+    bool back = false;
+    bool left = false;
+    bool right = false;
+    bool up = false;   // 歩いているときはジャンプ
+    bool down = false;
+    bool fly = false;  // 重力を切って上下に飛ぶ
+    float lookX = 0.0f;
+    float lookY = 0.0f;
+};
+
+constexpr float PLAYER_SPEED = 6.0f;            // ブロック/秒 (以前の 0.2 x 30FPS と同じ)
+constexpr float MOUSE_SENSITIVITY = 0.003f;     // ラジアン/ピクセル
+constexpr float PLAYER_EYE_HEIGHT = 1.6f;       // 足元から目までの高さ
+constexpr float PLAYER_JUMP_SPEED = 8.0f;       // 重力 25 で 1.25 ブロックくらい跳ぶ
+
+// 入力から向きと速度を決める (動かすのは Physics)
+void stepPlayer(PlayerState& player, PhysicsBody& body, const PlayerInput& input);
+
+// 固定タイムステップのシミュレーションを専用スレッドで回す
+// 結果は 2 つのバッファを入れ替えて渡し、描画側は前後の tick を補間して使う
+class Simulation {
+public:
+    static constexpr int TICKS_PER_SECOND = 60;
+    static constexpr int MAX_CATCH_UP_TICKS = 5; // これ以上遅れたら諦めて追いつかない
+
+    // world はメインスレッドが持ったまま。tick ではその mutex を shared でロックして読む
+    Simulation(const PlayerState& initial, const World& world);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    void start();
+    void stop();
+
+    // メインスレッドから毎フレーム
+    void addInput(const PlayerInput& input);
+    // 今の時刻に合わせて前後の tick を補間した状態
+    PlayerState interpolated() const;
+    // 最後の tick の結果そのまま (補間しない)。当たり判定と合わせるときはこちら
+    PlayerState latest() const;
+
+    // 動かない当たり判定の箱 (置き物の外接箱など) を差し替える。次の tick から使う
+    void setStaticColliders(const std::vector<Aabb>& boxes);
+    // Physics::setRequiredChunkRange と同じ。start の前に呼ぶ
+    void setRequiredChunkRange(int minChunkY, int maxChunkY) { physics.setRequiredChunkRange(minChunkY, maxChunkY); }
+
+private:
+    struct Snapshot {
+        PlayerState previous;
+        PlayerState current;
+        std::uint64_t timeNs; // current ができた時刻
+    };
+
+    void run();
+    void tick();
+
+    // シミュレーションスレッドだけが触る
+    PlayerState player;
+    std::vector<PhysicsBody> bodies; // 0 番がプレイヤー (動くものはここに足していく)
+    Physics physics;
+    const World& world;
+
+    mutable std::mutex inputMutex;
+    PlayerInput pendingInput;
+    std::vector<Aabb> pendingColliders;
+    bool collidersChanged = false;
+
+    // ダブルバッファ。back を書いてから front と入れ替える
+    mutable std::mutex snapshotMutex;
+    Snapshot buffers[2];
+    Snapshot* front = &buffers[0];
+    Snapshot* back = &buffers[1];
+
+    std::atomic<bool> running{ false };
+    std::thread thread;
+};
@@ -0,0 +1,112 @@
+#include "terrain.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "blocks.hpp"
+
+namespace {
+
+constexpr int OCTAVES = 4;
+constexpr float BASE_FREQUENCY = 1.0f / 96.0f;
+
+// 格子点ごとの乱数 (0..1)
+float latticeValue(int x, int z, std::uint32_t seed)
+{
+    std::uint32_t h = seed;
+    h ^= static_cast<std::uint32_t>(x) * 0x27d4eb2du;
+    h ^= static_cast<std::uint32_t>(z) * 0x165667b1u;
+    h ^= h >> 15;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return (h & 0xffffff) / static_cast<float>(0xffffff);
+}
+
+float smooth(float t)
+{
+    return t * t * (3.0f - 2.0f * t);
+}
+
+} // namespace
+
+TerrainGenerator::TerrainGenerator(std::uint32_t seed) : seed(seed) {}
+
+float TerrainGenerator::valueNoise(float x, float z) const
+{
+    float fx = std::floor(x);
+    float fz = std::floor(z);
+    int ix = static_cast<int>(fx);
+    int iz = static_cast<int>(fz);
+    float tx = smooth(x - fx);
+    float tz = smooth(z - fz);
+
+    float v00 = latticeValue(ix, iz, seed);
+    float v10 = latticeValue(ix + 1, iz, seed);
+    float v01 = latticeValue(ix, iz + 1, seed);
+    float v11 = latticeValue(ix + 1, iz + 1, seed);
+    float a = v00 + (v10 - v00) * tx;
+    float b = v01 + (v11 - v01) * tx;
+    return (a + (b - a) * tz) * 2.0f - 1.0f;
+}
+
+float TerrainGenerator::fractalNoise(float x, float z) const
+{
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    for (int i = 0; i < OCTAVES; i++)
+    {
+        sum += valueNoise(x, z) * amplitude;
+        total += amplitude;
+        amplitude *= 0.5f;
+        x *= 2.0f;
+        z *= 2.0f;
+    }
+    return sum / total;
+}
+
+int TerrainGenerator::heightAt(int x, int z) const
+{
+    float n = fractalNoise(x * BASE_FREQUENCY, z * BASE_FREQUENCY);
+    float middle = (MIN_HEIGHT + MAX_HEIGHT) * 0.5f;
+    float range = (MAX_HEIGHT - MIN_HEIGHT) * 0.5f;
+    int height = static_cast<int>(std::lround(middle + n * range));
+    return std::clamp(height, MIN_HEIGHT, MAX_HEIGHT);
+}
+
+BlockId TerrainGenerator::blockAt(int y, int height)
+{
+    if (y < 0 || y >= height) return BLOCK_AIR;
+    if (height <= SAND_LEVEL) return y >= height - 3 ? BLOCK_SAND : BLOCK_STONE;
+    if (y == height - 1) return BLOCK_GRASS;
+    if (y >= height - 4) return BLOCK_DIRT;
+    return BLOCK_STONE;
+}
+
+void TerrainGenerator::generateChunk(const ChunkCoord& coord, Chunk& out) const
+{
+    // 列ごとの高さを先に求めておく
+    int heights[CHUNK_SIZE * CHUNK_SIZE];
+    const int baseX = coord.x * CHUNK_SIZE;
+    const int baseY = coord.y * CHUNK_SIZE;
+    const int baseZ = coord.z * CHUNK_SIZE;
+    for (int lz = 0; lz < CHUNK_SIZE; lz++)
+    for (int lx = 0; lx < CHUNK_SIZE; lx++)
+    {
+        heights[lx + CHUNK_SIZE * lz] = heightAt(baseX + lx, baseZ + lz);
+    }
+
+    out.solidCount = 0;
+    for (int ly = 0; ly < CHUNK_SIZE; ly++)
+    for (int lz = 0; lz < CHUNK_SIZE; lz++)
+    for (int lx = 0; lx < CHUNK_SIZE; lx++)
+    {
+        BlockId type = blockAt(baseY + ly, heights[lx + CHUNK_SIZE * lz]);
+        out.blocks[Chunk::index(lx, ly, lz)] = type;
+        if (type != BLOCK_AIR) out.solidCount++;
+    }
+    out.saveDirty = false; // seed から作り直せる
+    out.meshRevision = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include "world.hpp"
+
+// ノイズの高さマップで地形を作る (石・土・草、低いところは砂)
+// 同じ seed なら同じ地形になるので、いじっていないチャンクはセーブしなくてよい
+// const メソッドはどのスレッドから同時に呼んでもよい
+class TerrainGenerator {
+public:
+    static constexpr int MIN_HEIGHT = 4;
+    static constexpr int MAX_HEIGHT = 56;
+    static constexpr int SAND_LEVEL = 18; // これより低い地面は砂
+
+    explicit TerrainGenerator(std::uint32_t seed = 1);
+
+    // (x, z) の地面の高さ。y < heightAt(x, z) が地面
+    int heightAt(int x, int z) const;
+    // 高さ height の列の y 段目のブロック
+    static BlockId blockAt(int y, int height);
+
+    // チャンク 1 つぶんを埋める (out は空でなくてもよい)
+    void generateChunk(const ChunkCoord& coord, Chunk& out) const;
+
+    // 地形があるチャンクの y の範囲 (これより上は空気、下は何も無い)
+    static int minChunkY() { return 0; }
+    static int maxChunkY() { return (MAX_HEIGHT - 1) / CHUNK_SIZE; }
+
+private:
+    // 格子点の値を補間するノイズ (-1..1)
+    float valueNoise(float x, float z) const;
+    // 周波数を変えて重ねたもの (-1..1)
+    float fractalNoise(float x, float z) const;
+
+    std::uint32_t seed;
+};
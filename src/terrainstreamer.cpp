@@ -0,0 +1,228 @@
+#include "terrainstreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+namespace {
+
+// チャンクの中心までの距離
+float distanceToChunk(const ChunkCoord& c, float x, float y, float z)
+{
+    const float half = CHUNK_SIZE * 0.5f;
+    float dx = c.x * CHUNK_SIZE + half - x;
+    float dy = c.y * CHUNK_SIZE + half - y;
+    float dz = c.z * CHUNK_SIZE + half - z;
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace
+
+TerrainStreamer::TerrainStreamer(const TerrainGenerator& generator, JobSystem& jobs)
+    : generator(generator), jobs(jobs)
+{
+}
+
+TerrainStreamer::~TerrainStreamer()
+{
+    for (auto& entry : inFlight) entry.second->store(true);
+}
+
+void TerrainStreamer::setStorage(ChunkSource& newSource, WorldSaver& newSaver)
+{
+    source = &newSource;
+    saver = &newSaver;
+}
+
+void TerrainStreamer::recomputeWanted(const ChunkCoord& center, const ChunkCoord& ahead, float radius)
+{
+    wanted.clear();
+    int r = static_cast<int>(std::ceil(radius / CHUNK_SIZE));
+    keepRadius = r + 1; // 境目で行ったり来たりしないよう 1 チャンク分余裕をみる
+    auto columnDistance = [](const ChunkCoord& a, int x, int z) {
+        int dx = a.x - x;
+        int dz = a.z - z;
+        return dx * dx + dz * dz;
+    };
+    // 今いるところと少し先、それぞれの周りの円の中の列を、地形のある高さの分だけ
+    int minX = std::min(center.x, ahead.x) - r, maxX = std::max(center.x, ahead.x) + r;
+    int minZ = std::min(center.z, ahead.z) - r, maxZ = std::max(center.z, ahead.z) + r;
+    for (int cz = minZ; cz <= maxZ; cz++)
+    for (int cx = minX; cx <= maxX; cx++)
+    {
+        if (columnDistance(center, cx, cz) > r * r && columnDistance(ahead, cx, cz) > r * r) continue;
+        for (int cy = TerrainGenerator::minChunkY(); cy <= TerrainGenerator::maxChunkY(); cy++)
+        {
+            wanted.push_back({ cx, cy, cz });
+        }
+    }
+    // 先のほうに近い順 (進む向きのチャンクから届く)
+    auto distance = [&](const ChunkCoord& c) {
+        int dy = c.y - center.y;
+        return columnDistance(ahead, c.x, c.z) + dy * dy;
+    };
+    std::sort(wanted.begin(), wanted.end(),
+              [&](const ChunkCoord& a, const ChunkCoord& b) { return distance(a) < distance(b); });
+}
+
+bool TerrainStreamer::insideKeep(const ChunkCoord& coord) const
+{
+    auto inside = [&](const ChunkCoord& around) {
+        int dx = coord.x - around.x;
+        int dz = coord.z - around.z;
+        return dx * dx + dz * dz <= keepRadius * keepRadius;
+    };
+    return inside(wantedCenter) || inside(wantedAhead);
+}
+
+void TerrainStreamer::update(World& world, float x, float y, float z, float radius)
+{
+    frame++;
+
+    // 進んでいる向きをならしておく (止まったら少しずつ 0 に戻す、ワープは無視)
+    if (hasLast)
+    {
+        float dx = x - lastX;
+        float dz = z - lastZ;
+        float length = std::sqrt(dx * dx + dz * dz);
+        if (length > 1e-3f && length < radius)
+        {
+            travelX = travelX * 0.9f + dx / length * 0.1f;
+            travelZ = travelZ * 0.9f + dz / length * 0.1f;
+        }
+        else if (length <= 1e-3f)
+        {
+            travelX *= 0.9f;
+            travelZ *= 0.9f;
+        }
+    }
+    lastX = x;
+    lastZ = z;
+    hasLast = true;
+    const float aheadX = x + travelX * LOOKAHEAD;
+    const float aheadZ = z + travelZ * LOOKAHEAD;
+
+    ChunkCoord center = chunkCoordOf(static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)),
+                                     static_cast<int>(std::floor(z)));
+    ChunkCoord ahead = chunkCoordOf(static_cast<int>(std::floor(aheadX)), static_cast<int>(std::floor(y)),
+                                    static_cast<int>(std::floor(aheadZ)));
+    if (center != wantedCenter || ahead != wantedAhead || radius != wantedRadius)
+    {
+        recomputeWanted(center, ahead, radius);
+        wantedCenter = center;
+        wantedAhead = ahead;
+        wantedRadius = radius;
+        evictStalled = false; // 範囲の外になったチャンクが増えたかもしれない
+
+        // 範囲から出た列は取り消す
+        for (auto it = inFlight.begin(); it != inFlight.end();)
+        {
+            // 範囲の外でも、届くのを待っている変更があるチャンクは最後まで作る
+            if (!insideKeep(it->first) && world.cancelLoading(it->first))
+            {
+                it->second->store(true);
+                it = inFlight.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (const ChunkCoord& coord : wanted)
+    {
+        if (world.findLoadedChunk(coord))
+        {
+            lastUsed[coord] = frame;
+            continue;
+        }
+        if (inFlight.count(coord)) continue;
+
+        // セーブファイルにあればそれを読む (メインスレッドで読まない)。無ければ作る
+        ChunkSource* storage = source && source->hasChunk(coord) ? source : nullptr;
+        JobSystem::CancelToken cancel = JobSystem::makeCancelToken();
+        inFlight.emplace(coord, cancel);
+        world.beginLoading(coord);
+        const TerrainGenerator& terrain = generator;
+        const char* name = storage ? "page in" : "generate";
+        jobs.run(name, distanceToChunk(coord, aheadX, y, aheadZ), [&terrain, storage, &world, this, coord]() -> std::function<void()> {
+            auto chunk = std::make_shared<Chunk>();
+            if (!storage || !storage->loadChunk(coord, *chunk)) terrain.generateChunk(coord, *chunk);
+            chunk->saveDirty = false; // ファイルと同じか、seed から作り直せる
+            return [&world, this, coord, chunk]() {
+                inFlight.erase(coord);
+                bool inserted;
+                {
+                    std::unique_lock<std::shared_mutex> lock(world.mutex());
+                    inserted = world.insertChunk(coord, *chunk);
+                }
+                if (inserted) lastUsed[coord] = frame;
+            };
+        }, cancel);
+    }
+
+    // 減らせなかったときは、チャンクが増減するかセーブが確かめられる (か失敗する) まで候補を並べ直さない
+    bool stalled = evictStalled && world.chunkCount() == stalledChunks &&
+                   (!saver || (saver->cleanedChunks() == stalledCleaned && saver->failures() == stalledFailures));
+    if (world.memoryBytes() > memoryBudget && !stalled) evict(world);
+    lastResidentChunks = world.chunkCount();
+    lastResidentBytes = world.memoryBytes();
+}
+
+void TerrainStreamer::evict(World& world)
+{
+    // ファイルに書けたと確かめられたチャンクだけが dirty でなくなる
+    if (saver) saver->applySaved(world);
+
+    // 範囲の外のものを、最後に範囲の中にあったのが古い順に
+    std::vector<std::pair<std::uint64_t, ChunkCoord>> candidates;
+    for (const auto& entry : world.allChunks())
+    {
+        if (insideKeep(entry.first))
+        {
+            lastUsed[entry.first] = frame;
+            continue;
+        }
+        auto it = lastUsed.find(entry.first);
+        candidates.push_back({ it == lastUsed.end() ? 0 : it->second, entry.first });
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    // いじったチャンクはファイルに書けたとわかるまで残す (書き込みに失敗したらずっと残る)
+    // dirty でないものはファイルと同じか、seed から作り直せる
+    bool needSave = false;
+    for (const auto& candidate : candidates)
+    {
+        if (world.memoryBytes() <= memoryBudget) break;
+        const Chunk* chunk = world.findLoadedChunk(candidate.second);
+        if (chunk->saveDirty)
+        {
+            needSave = true; // セーブしてから次のフレーム以降で
+            continue;
+        }
+        {
+            std::unique_lock<std::shared_mutex> lock(world.mutex());
+            world.removeChunk(candidate.second);
+        }
+        lastUsed.erase(candidate.second);
+        evictedCount++;
+    }
+    // 前のセーブが終わっていなければ、同じチャンクを重ねて頼まない
+    bool requested = false;
+    if (needSave && saver && !saver->busy())
+    {
+        saver->requestSave(world);
+        requested = true;
+    }
+
+    // セーブを頼めなかったときは次のフレームでもう一度
+    evictStalled = world.memoryBytes() > memoryBudget && (!needSave || !saver || requested);
+    stalledChunks = world.chunkCount();
+    stalledCleaned = saver ? saver->cleanedChunks() : 0;
+    stalledFailures = saver ? saver->failures() : 0;
+}
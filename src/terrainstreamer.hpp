@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "jobsystem.hpp"
+#include "terrain.hpp"
+#include "world.hpp"
+#include "worldio.hpp"
+
+// プレイヤーの周りのチャンクをメモリに置いておく
+//   読み込み: まだ無いチャンクはセーブファイルから読むか地形を作る (どちらもジョブシステムで)
+//             進んでいる向きの少し先も先に読んでおく
+//   追い出し: 範囲の外のチャンクはメモリの上限を超えたら使っていない順に捨てる
+//             いじったチャンクはセーブして、ファイルに書けたと確かめてから (いじっていないものは作り直せるのでそのまま)
+// セーブファイルにあるチャンクは地形より優先 (いじった地形を上書きしない)
+class TerrainStreamer {
+public:
+    static constexpr float LOOKAHEAD = 32.0f;                               // 進む向きにこれだけ先まで読む (ブロック)
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET = 64u * 1024u * 1024u; // バイト
+
+    // generator と jobs はこれより長生きさせる
+    TerrainStreamer(const TerrainGenerator& generator, JobSystem& jobs);
+    ~TerrainStreamer();
+
+    TerrainStreamer(const TerrainStreamer&) = delete;
+    TerrainStreamer& operator=(const TerrainStreamer&) = delete;
+
+    // 読み込み元と、追い出す前に書き込む先 (どちらもこれより長生きさせる)
+    // 設定しないときは作り直せるチャンクだけを追い出す
+    void setStorage(ChunkSource& source, WorldSaver& saver);
+    // 範囲の外のチャンクを残しておける上限。範囲の中だけで超えるときはそちらが優先
+    void setMemoryBudget(std::size_t bytes)
+    {
+        memoryBudget = bytes;
+        evictStalled = false;
+    }
+
+    // メインスレッドから毎フレーム。world を書き換えるとき (入れる・外す) だけ world.mutex() を unique でロックする
+    // (x, y, z) から radius ブロック以内のチャンクを頼み、範囲から外れたまだ始まっていない読み込みは取り消す
+    void update(World& world, float x, float y, float z, float radius);
+
+    // 読み込み・生成待ちのチャンク数
+    int pending() const { return static_cast<int>(inFlight.size()); }
+    // 直前の update の時点でメモリにあるチャンク数とバイト数
+    std::size_t residentChunks() const { return lastResidentChunks; }
+    std::size_t residentBytes() const { return lastResidentBytes; }
+    // これまでに追い出したチャンク数
+    std::uint64_t evictedChunks() const { return evictedCount; }
+
+private:
+    void recomputeWanted(const ChunkCoord& center, const ChunkCoord& ahead, float radius);
+    bool insideKeep(const ChunkCoord& coord) const;
+    void evict(World& world);
+
+    const TerrainGenerator& generator;
+    JobSystem& jobs;
+    ChunkSource* source = nullptr;
+    WorldSaver* saver = nullptr;
+    std::size_t memoryBudget = DEFAULT_MEMORY_BUDGET;
+
+    // 範囲内のチャンク (進む向きの先に近い順)
+    std::vector<ChunkCoord> wanted;
+    ChunkCoord wantedCenter{ 0, 0, 0 };
+    ChunkCoord wantedAhead{ 0, 0, 0 };
+    float wantedRadius = -1.0f;
+    int keepRadius = 0; // チャンク単位。これより外の列が追い出す候補
+
+    // 進んでいる向き (水平、長さ 1 以下)
+    float lastX = 0.0f;
+    float lastZ = 0.0f;
+    float travelX = 0.0f;
+    float travelZ = 0.0f;
+    bool hasLast = false;
+
+    std::unordered_map<ChunkCoord, JobSystem::CancelToken, ChunkCoordHash> inFlight;
+    // 最後に範囲の中にあったフレーム
+    std::unordered_map<ChunkCoord, std::uint64_t, ChunkCoordHash> lastUsed;
+    std::uint64_t frame = 0;
+
+    // 前の evict で上限まで減らせなかったときの様子。これが変わるまで evict しない
+    bool evictStalled = false;
+    std::size_t stalledChunks = 0;
+    std::uint64_t stalledCleaned = 0;
+    int stalledFailures = 0;
+
+    std::size_t lastResidentChunks = 0;
+    std::size_t lastResidentBytes = 0;
+    std::uint64_t evictedCount = 0;
+};
@@ -0,0 +1,171 @@
+#include "world.hpp"
+
+BlockId World::getBlock(int x, int y, int z) const
+{
+    const Chunk* chunk = findChunk(chunkCoordOf(x, y, z));
+    if (!chunk) return BLOCK_AIR;
+    return chunk->get(floorMod(x, CHUNK_SIZE), floorMod(y, CHUNK_SIZE), floorMod(z, CHUNK_SIZE));
+}
+
+void World::setBlock(int x, int y, int z, BlockId type)
+{
+    ChunkCoord coord = chunkCoordOf(x, y, z);
+    int lx = floorMod(x, CHUNK_SIZE);
+    int ly = floorMod(y, CHUNK_SIZE);
+    int lz = floorMod(z, CHUNK_SIZE);
+    Chunk* chunk = findChunk(coord);
+    if (!chunk)
+    {
+        auto pending = loading.find(coord);
+        if (pending != loading.end())
+        {
+            // まだ作っている途中。届いたら重ねる
+            pending->second.push_back({ Chunk::index(lx, ly, lz), type });
+            return;
+        }
+        if (type == BLOCK_AIR) return; // 空気を置くためだけにチャンクは作らない
+        chunk = &getOrCreateChunk(coord);
+    }
+    applyEdit(*chunk, coord, lx, ly, lz, type);
+}
+
+void World::applyEdit(Chunk& chunk, const ChunkCoord& coord, int lx, int ly, int lz, BlockId type)
+{
+    if (!chunk.set(lx, ly, lz, type)) return;
+
+    chunk.saveDirty = true;
+    chunk.saveRevision++;
+    chunk.meshRevision++;
+    // 境界のブロックなら隣のチャンクの面も変わる
+    if (lx == 0) touchNeighbour({ coord.x - 1, coord.y, coord.z });
+    if (lx == CHUNK_SIZE - 1) touchNeighbour({ coord.x + 1, coord.y, coord.z });
+    if (ly == 0) touchNeighbour({ coord.x, coord.y - 1, coord.z });
+    if (ly == CHUNK_SIZE - 1) touchNeighbour({ coord.x, coord.y + 1, coord.z });
+    if (lz == 0) touchNeighbour({ coord.x, coord.y, coord.z - 1 });
+    if (lz == CHUNK_SIZE - 1) touchNeighbour({ coord.x, coord.y, coord.z + 1 });
+}
+
+Chunk* World::findChunk(const ChunkCoord& coord)
+{
+    auto it = chunks.find(coord);
+    if (it != chunks.end()) return it->second.get();
+    return loadFromSource(coord);
+}
+
+const Chunk* World::findChunk(const ChunkCoord& coord) const
+{
+    auto it = chunks.find(coord);
+    if (it != chunks.end()) return it->second.get();
+    return loadFromSource(coord);
+}
+
+const Chunk* World::findLoadedChunk(const ChunkCoord& coord) const
+{
+    auto it = chunks.find(coord);
+    return it == chunks.end() ? nullptr : it->second.get();
+}
+
+Chunk& World::getOrCreateChunk(const ChunkCoord& coord)
+{
+    if (Chunk* chunk = findChunk(coord)) return *chunk;
+    std::unique_ptr<Chunk>& slot = chunks[coord];
+    slot = std::make_unique<Chunk>();
+    touchNeighbours(coord);
+    return *slot;
+}
+
+bool World::insertChunk(const ChunkCoord& coord, const Chunk& chunk)
+{
+    std::vector<DeferredEdit> edits;
+    auto pending = loading.find(coord);
+    if (pending != loading.end())
+    {
+        edits.swap(pending->second);
+        loading.erase(pending);
+    }
+    if (findLoadedChunk(coord)) return false;
+
+    std::unique_ptr<Chunk>& slot = chunks[coord];
+    slot = std::make_unique<Chunk>(chunk);
+    touchNeighbours(coord);
+    for (const DeferredEdit& edit : edits)
+    {
+        int lx = edit.index % CHUNK_SIZE;
+        int lz = (edit.index / CHUNK_SIZE) % CHUNK_SIZE;
+        int ly = edit.index / (CHUNK_SIZE * CHUNK_SIZE);
+        applyEdit(*slot, coord, lx, ly, lz, edit.type);
+    }
+    return true;
+}
+
+void World::beginLoading(const ChunkCoord& coord)
+{
+    loading.emplace(coord, std::vector<DeferredEdit>());
+}
+
+bool World::cancelLoading(const ChunkCoord& coord)
+{
+    auto pending = loading.find(coord);
+    if (pending == loading.end()) return true;
+    if (!pending->second.empty()) return false;
+    loading.erase(pending);
+    return true;
+}
+
+bool World::removeChunk(const ChunkCoord& coord)
+{
+    if (chunks.erase(coord) == 0) return false;
+    touchNeighbours(coord); // 境目の面が見えるようになる
+    return true;
+}
+
+Chunk* World::loadFromSource(const ChunkCoord& coord) const
+{
+    if (!source || !source->hasChunk(coord)) return nullptr;
+    auto chunk = std::make_unique<Chunk>();
+    if (!source->loadChunk(coord, *chunk)) return nullptr;
+    chunk->saveDirty = false; // ファイルと同じ内容
+    Chunk* loaded = chunk.get();
+    chunks[coord] = std::move(chunk);
+    touchNeighbours(coord);
+    return loaded;
+}
+
+void World::touchNeighbour(const ChunkCoord& coord) const
+{
+    auto it = chunks.find(coord);
+    if (it != chunks.end()) it->second->meshRevision++;
+}
+
+void World::touchNeighbours(const ChunkCoord& coord) const
+{
+    touchNeighbour({ coord.x - 1, coord.y, coord.z });
+    touchNeighbour({ coord.x + 1, coord.y, coord.z });
+    touchNeighbour({ coord.x, coord.y - 1, coord.z });
+    touchNeighbour({ coord.x, coord.y + 1, coord.z });
+    touchNeighbour({ coord.x, coord.y, coord.z - 1 });
+    touchNeighbour({ coord.x, coord.y, coord.z + 1 });
+}
+
+void World::loadAllChunks()
+{
+    if (!source) return;
+    for (const ChunkCoord& coord : source->storedChunks())
+    {
+        if (chunks.find(coord) == chunks.end()) loadFromSource(coord);
+    }
+}
+
+std::size_t World::blockCount() const
+{
+    std::size_t count = 0;
+    for (const auto& entry : chunks) count += entry.second->solidCount;
+    return count;
+}
+
+std::size_t World::memoryBytes() const
+{
+    // 本体 + ノード (キーとポインタと次へのポインタ) + バケット
+    const std::size_t perChunk = sizeof(Chunk) + sizeof(ChunkMap::value_type) + sizeof(void*);
+    return chunks.size() * perChunk + chunks.bucket_count() * sizeof(void*);
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// ブロックの種類 (0 は空気)
+using BlockId = std::uint8_t;
+constexpr BlockId BLOCK_AIR = 0;
+
+// チャンクの一辺のブロック数
+constexpr int CHUNK_SIZE = 16;
+constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// チャンク座標 (ワールド座標 / CHUNK_SIZE を切り捨て)
+struct ChunkCoord {
+    int x;
+    int y;
+    int z;
+
+    bool operator==(const ChunkCoord& other) const
+    {
+        return x == other.x && y == other.y && z == other.z;
+    }
+    bool operator!=(const ChunkCoord& other) const { return !(*this == other); }
+};
+
+struct ChunkCoordHash {
+    std::size_t operator()(const ChunkCoord& c) const
+    {
+        // 大きめの素数を掛けて混ぜるだけ
+        std::uint64_t h = static_cast<std::uint32_t>(c.x) * 73856093ull;
+        h ^= static_cast<std::uint32_t>(c.y) * 19349663ull;
+        h ^= static_cast<std::uint32_t>(c.z) * 83492791ull;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+// 負の座標でも正しく切り捨てる割り算と余り
+inline int floorDiv(int a, int b)
+{
+    int q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+inline int floorMod(int a, int b)
+{
+    int m = a % b;
+    if (m < 0) m += b;
+    return m;
+}
+
+inline ChunkCoord chunkCoordOf(int x, int y, int z)
+{
+    return { floorDiv(x, CHUNK_SIZE), floorDiv(y, CHUNK_SIZE), floorDiv(z, CHUNK_SIZE) };
+}
+
+// 16x16x16 ブロックのかたまり
+struct Chunk {
+    std::array<BlockId, CHUNK_VOLUME> blocks{};
+    int solidCount = 0; // 空気以外のブロック数
+    bool saveDirty = true; // ファイルに書き終えたと確かめられていない変更があるか
+    std::uint32_t saveRevision = 0; // 変更のたびに増える (どの版まで書けたかを確かめる)
+    std::uint32_t meshRevision = 0; // 見た目が変わるたびに増える (自分か隣の境界が変わったとき)
+
+    static int index(int lx, int ly, int lz)
+    {
+        return lx + CHUNK_SIZE * (lz + CHUNK_SIZE * ly);
+    }
+
+    BlockId get(int lx, int ly, int lz) const { return blocks[index(lx, ly, lz)]; }
+
+    // 値が変わったら true
+    bool set(int lx, int ly, int lz, BlockId type)
+    {
+        BlockId& slot = blocks[index(lx, ly, lz)];
+        if (slot == type) return false;
+        if (slot == BLOCK_AIR) solidCount++;
+        if (type == BLOCK_AIR) solidCount--;
+        slot = type;
+        return true;
+    }
+
+    bool empty() const { return solidCount == 0; }
+};
+
+// メモリにないチャンクを読み込んでくる先 (セーブファイルなど)
+class ChunkSource {
+public:
+    virtual ~ChunkSource() = default;
+
+    virtual bool hasChunk(const ChunkCoord& coord) const = 0;
+    // 見つかったら out に書き込んで true
+    virtual bool loadChunk(const ChunkCoord& coord, Chunk& out) = 0;
+    virtual std::vector<ChunkCoord> storedChunks() const = 0;
+};
+
+// チャンクのハッシュマップで管理するワールド
+class World {
+public:
+    using ChunkMap = std::unordered_map<ChunkCoord, std::unique_ptr<Chunk>, ChunkCoordHash>;
+
+    // 未読み込みのチャンクは初めて触られたときに source から読む
+    void setSource(ChunkSource* newSource) { source = newSource; }
+    // source にあるチャンクを全部読み込む
+    void loadAllChunks();
+
+    BlockId getBlock(int x, int y, int z) const;
+
+    // 同じ座標に置いたら上書き (追加はしない)
+    void setBlock(int x, int y, int z, BlockId type);
+
+    Chunk* findChunk(const ChunkCoord& coord);
+    const Chunk* findChunk(const ChunkCoord& coord) const;
+    // source から読み込まずに、メモリにあるものだけ探す
+    const Chunk* findLoadedChunk(const ChunkCoord& coord) const;
+    Chunk& getOrCreateChunk(const ChunkCoord& coord);
+    // 別のスレッドで作った・読んだチャンクを入れる。メモリにすでにあるときは何もせず false
+    // (source を引かないので、セーブファイルにあるかは呼び出し側で確かめておく)
+    // beginLoading の後にためておいた変更は、入れたチャンクの上に重ねる
+    bool insertChunk(const ChunkCoord& coord, const Chunk& chunk);
+    // coord のチャンクは別のスレッドで作っていて insertChunk で届く
+    // 届くまでの setBlock は空のチャンクを作らずにためておく (作った地形が捨てられて穴にならないように)
+    void beginLoading(const ChunkCoord& coord);
+    // 届かなくなったとき。ためている変更があれば取りやめずに false (そのまま届くのを待つ)
+    bool cancelLoading(const ChunkCoord& coord);
+    // メモリから外す (セーブは呼び出し側で)。無ければ false
+    bool removeChunk(const ChunkCoord& coord);
+
+    void clear()
+    {
+        chunks.clear();
+        loading.clear();
+    }
+
+    // 以下は読み込み済みのチャンクだけが対象
+    std::size_t chunkCount() const { return chunks.size(); }
+    std::size_t blockCount() const;
+    // チャンクとハッシュマップが使っているメモリのおおよそのバイト数
+    std::size_t memoryBytes() const;
+
+    const ChunkMap& allChunks() const { return chunks; }
+
+    // 書き換えるのはメインスレッドだけ。別のスレッドから読むときは shared で、
+    // メインスレッドで書き換える (setBlock・insertChunk・removeChunk) ときはその呼び出しの間だけ unique でロックする
+    // メインスレッドが読むだけならロックはいらない
+    std::shared_mutex& mutex() const { return accessMutex; }
+
+private:
+    // チャンクが届くまでためておく変更
+    struct DeferredEdit {
+        int index; // Chunk::index
+        BlockId type;
+    };
+
+    Chunk* loadFromSource(const ChunkCoord& coord) const;
+    // chunk の (lx, ly, lz) を変えて、セーブとメッシュの印をつける
+    void applyEdit(Chunk& chunk, const ChunkCoord& coord, int lx, int ly, int lz, BlockId type);
+    void touchNeighbour(const ChunkCoord& coord) const;
+    void touchNeighbours(const ChunkCoord& coord) const;
+
+    // 遅延読み込みのキャッシュでもあるので const メソッドからも埋める
+    mutable ChunkMap chunks;
+    ChunkSource* source = nullptr;
+    mutable std::shared_mutex accessMutex;
+    std::unordered_map<ChunkCoord, std::vector<DeferredEdit>, ChunkCoordHash> loading;
+};
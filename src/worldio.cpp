@@ -0,0 +1,461 @@
+#include "worldio.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "profiler.hpp"
+
+namespace {
+
+constexpr char FILE_MAGIC[4] = { 'M', 'G', 'W', 'D' };
+constexpr std::size_t HEADER_SIZE = 24;      // magic, version, 索引位置 u64, チャンク数, 予約
+constexpr std::size_t INDEX_ENTRY_SIZE = 24; // x, y, z, 長さ, 位置 u64
+constexpr std::size_t RUN_SIZE = 3;          // 個数 u16, 種類 u8
+
+// ゴミ (古い本体と索引) がこれを超えて、かつ生きているデータより多ければ全部書き直す
+constexpr std::uint64_t COMPACT_MIN_GARBAGE = 256 * 1024;
+
+void putU16(std::vector<std::uint8_t>& out, std::uint16_t v)
+{
+    out.push_back(static_cast<std::uint8_t>(v));
+    out.push_back(static_cast<std::uint8_t>(v >> 8));
+}
+
+void putU32(std::vector<std::uint8_t>& out, std::uint32_t v)
+{
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+void putU64(std::vector<std::uint8_t>& out, std::uint64_t v)
+{
+    for (int i = 0; i < 8; i++) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+}
+
+std::uint16_t getU16(const std::uint8_t* p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t getU32(const std::uint8_t* p)
+{
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+std::uint64_t getU64(const std::uint8_t* p)
+{
+    std::uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+    return v;
+}
+
+std::vector<std::uint8_t> makeHeader(std::uint64_t indexOffset, std::uint32_t chunkCount)
+{
+    std::vector<std::uint8_t> header(FILE_MAGIC, FILE_MAGIC + 4);
+    putU32(header, WORLD_FILE_VERSION);
+    putU64(header, indexOffset);
+    putU32(header, chunkCount);
+    putU32(header, 0);
+    return header;
+}
+
+template <typename Index>
+std::vector<std::uint8_t> makeIndex(const Index& index)
+{
+    std::vector<std::uint8_t> out;
+    out.reserve(index.size() * INDEX_ENTRY_SIZE);
+    for (const auto& entry : index)
+    {
+        putU32(out, static_cast<std::uint32_t>(entry.first.x));
+        putU32(out, static_cast<std::uint32_t>(entry.first.y));
+        putU32(out, static_cast<std::uint32_t>(entry.first.z));
+        putU32(out, entry.second.size);
+        putU64(out, entry.second.offset);
+    }
+    return out;
+}
+
+bool writeAt(int fd, const std::uint8_t* data, std::size_t size, std::uint64_t offset)
+{
+    while (size > 0)
+    {
+        ssize_t n = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+std::vector<std::uint8_t> encodeChunk(const std::array<BlockId, CHUNK_VOLUME>& blocks)
+{
+    std::vector<std::uint8_t> out;
+    int i = 0;
+    while (i < CHUNK_VOLUME)
+    {
+        BlockId type = blocks[i];
+        int run = 1;
+        while (i + run < CHUNK_VOLUME && blocks[i + run] == type) run++;
+        putU16(out, static_cast<std::uint16_t>(run));
+        out.push_back(type);
+        i += run;
+    }
+    return out;
+}
+
+bool decodeChunk(const std::uint8_t* data, std::size_t size, Chunk& out)
+{
+    if (size % RUN_SIZE != 0) return false;
+    int i = 0;
+    int solid = 0;
+    for (std::size_t p = 0; p < size; p += RUN_SIZE)
+    {
+        int run = getU16(data + p);
+        BlockId type = data[p + 2];
+        if (run == 0 || i + run > CHUNK_VOLUME) return false;
+        std::memset(out.blocks.data() + i, type, static_cast<std::size_t>(run));
+        if (type != BLOCK_AIR) solid += run;
+        i += run;
+    }
+    if (i != CHUNK_VOLUME) return false;
+    out.solidCount = solid;
+    return true;
+}
+
+// =====================================================================
+// WorldFile
+
+WorldFile::WorldFile(std::string path) : path(std::move(path)) {}
+
+WorldFile::~WorldFile()
+{
+    unmap();
+}
+
+bool WorldFile::open()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    unmap();
+    index.clear();
+    liveBytes = 0;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(HEADER_SIZE))
+    {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    mapped = static_cast<const std::uint8_t*>(p);
+    mappedSize = static_cast<std::size_t>(st.st_size);
+
+    std::uint64_t indexOffset = getU64(mapped + 8);
+    std::uint32_t count = getU32(mapped + 16);
+    if (std::memcmp(mapped, FILE_MAGIC, 4) != 0 || getU32(mapped + 4) != WORLD_FILE_VERSION ||
+        indexOffset + static_cast<std::uint64_t>(count) * INDEX_ENTRY_SIZE > mappedSize)
+    {
+        std::cerr << "セーブファイルが壊れています: " << path << std::endl;
+        unmap();
+        return false;
+    }
+
+    const std::uint8_t* entry = mapped + indexOffset;
+    for (std::uint32_t i = 0; i < count; i++, entry += INDEX_ENTRY_SIZE)
+    {
+        ChunkCoord coord = {
+            static_cast<int>(getU32(entry)),
+            static_cast<int>(getU32(entry + 4)),
+            static_cast<int>(getU32(entry + 8)),
+        };
+        IndexEntry e = { getU64(entry + 16), getU32(entry + 12) };
+        if (e.offset + e.size > indexOffset) continue; // 範囲外は読まない
+        index[coord] = e;
+        liveBytes += e.size;
+    }
+    return true;
+}
+
+bool WorldFile::hasChunk(const ChunkCoord& coord) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.find(coord) != index.end();
+}
+
+bool WorldFile::loadChunk(const ChunkCoord& coord, Chunk& out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(coord);
+    if (it == index.end()) return false;
+    return decodeChunk(mapped + it->second.offset, it->second.size, out);
+}
+
+std::vector<ChunkCoord> WorldFile::storedChunks() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<ChunkCoord> coords;
+    coords.reserve(index.size());
+    for (const auto& entry : index) coords.push_back(entry.first);
+    return coords;
+}
+
+std::size_t WorldFile::chunkCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.size();
+}
+
+std::uint64_t WorldFile::fileBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return mappedSize;
+}
+
+bool WorldFile::writeChunks(const std::vector<ChunkSnapshot>& dirty)
+{
+    // index と mapped を書き換えるのはこのスレッドだけなので、読むだけならロックはいらない
+    if (!mapped) return rewriteAll(dirty);
+
+    std::uint64_t garbage = mappedSize - HEADER_SIZE - liveBytes - index.size() * INDEX_ENTRY_SIZE;
+    if (garbage > COMPACT_MIN_GARBAGE && garbage > liveBytes) return rewriteAll(dirty);
+    return appendChunks(dirty);
+}
+
+bool WorldFile::appendChunks(const std::vector<ChunkSnapshot>& dirty)
+{
+    int fd = ::open(path.c_str(), O_WRONLY);
+    if (fd < 0)
+    {
+        std::cerr << "ファイルを開けませんでした: " << path << std::endl;
+        return false;
+    }
+
+    // 古い索引は残したまま、その後ろに追記する (途中で落ちても前回のセーブは読める)
+    Index newIndex = index;
+    std::vector<std::uint8_t> body;
+    std::uint64_t offset = mappedSize;
+    for (const ChunkSnapshot& snap : dirty)
+    {
+        // 全部空気になったチャンクも書く (消すと次に読むとき地形が作り直されてしまう)
+        std::vector<std::uint8_t> payload = encodeChunk(snap.blocks);
+        newIndex[snap.coord] = { offset + body.size(), static_cast<std::uint32_t>(payload.size()) };
+        body.insert(body.end(), payload.begin(), payload.end());
+    }
+    std::uint64_t indexOffset = offset + body.size();
+    std::vector<std::uint8_t> indexBytes = makeIndex(newIndex);
+    body.insert(body.end(), indexBytes.begin(), indexBytes.end());
+
+    std::vector<std::uint8_t> header = makeHeader(indexOffset, static_cast<std::uint32_t>(newIndex.size()));
+    bool ok = writeAt(fd, body.data(), body.size(), offset) &&
+              fdatasync(fd) == 0 &&
+              writeAt(fd, header.data(), header.size(), 0);
+    ::close(fd);
+    if (!ok)
+    {
+        std::cerr << "セーブに失敗しました: " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return remap(std::move(newIndex));
+}
+
+bool WorldFile::rewriteAll(const std::vector<ChunkSnapshot>& dirty)
+{
+    std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "ファイルを開けませんでした: " << tmpPath << std::endl;
+        return false;
+    }
+
+    Index newIndex;
+    std::vector<std::uint8_t> body;
+    std::unordered_map<ChunkCoord, bool, ChunkCoordHash> replaced;
+    for (const ChunkSnapshot& snap : dirty)
+    {
+        replaced[snap.coord] = true;
+        std::vector<std::uint8_t> payload = encodeChunk(snap.blocks);
+        newIndex[snap.coord] = { HEADER_SIZE + body.size(), static_cast<std::uint32_t>(payload.size()) };
+        body.insert(body.end(), payload.begin(), payload.end());
+    }
+    // 変更のないチャンクは展開せずにそのままコピー
+    for (const auto& entry : index)
+    {
+        if (replaced.count(entry.first)) continue;
+        const std::uint8_t* src = mapped + entry.second.offset;
+        newIndex[entry.first] = { HEADER_SIZE + body.size(), entry.second.size };
+        body.insert(body.end(), src, src + entry.second.size);
+    }
+    std::uint64_t indexOffset = HEADER_SIZE + body.size();
+    std::vector<std::uint8_t> indexBytes = makeIndex(newIndex);
+    body.insert(body.end(), indexBytes.begin(), indexBytes.end());
+
+    std::vector<std::uint8_t> header = makeHeader(indexOffset, static_cast<std::uint32_t>(newIndex.size()));
+    bool ok = writeAt(fd, header.data(), header.size(), 0) &&
+              writeAt(fd, body.data(), body.size(), HEADER_SIZE) &&
+              fdatasync(fd) == 0;
+    ::close(fd);
+    if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "セーブに失敗しました: " << path << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return remap(std::move(newIndex));
+}
+
+bool WorldFile::remap(Index newIndex)
+{
+    unmap();
+    index.clear();
+    liveBytes = 0;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    mapped = static_cast<const std::uint8_t*>(p);
+    mappedSize = static_cast<std::size_t>(st.st_size);
+
+    index = std::move(newIndex);
+    for (const auto& entry : index) liveBytes += entry.second.size;
+    return true;
+}
+
+void WorldFile::unmap()
+{
+    if (mapped) munmap(const_cast<std::uint8_t*>(mapped), mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+// =====================================================================
+// WorldSaver
+
+WorldSaver::WorldSaver(WorldFile& file) : file(file), thread(&WorldSaver::run, this) {}
+
+WorldSaver::~WorldSaver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+std::size_t WorldSaver::requestSave(World& world)
+{
+    std::vector<ChunkSnapshot> dirty;
+    for (const auto& entry : world.allChunks())
+    {
+        Chunk& chunk = *entry.second;
+        if (!chunk.saveDirty) continue;
+        dirty.push_back({ entry.first, chunk.blocks, chunk.saveRevision });
+    }
+    if (dirty.empty()) return 0;
+
+    std::size_t count = dirty.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(dirty));
+    }
+    wake.notify_one();
+    return count;
+}
+
+void WorldSaver::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queue.empty() && !writing; });
+}
+
+std::size_t WorldSaver::applySaved(World& world)
+{
+    std::vector<std::pair<ChunkCoord, std::uint32_t>> done;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        done.swap(saved);
+    }
+    std::size_t count = 0;
+    for (const auto& entry : done)
+    {
+        auto it = world.allChunks().find(entry.first);
+        if (it == world.allChunks().end()) continue;
+        Chunk& chunk = *it->second;
+        if (chunk.saveRevision != entry.second) continue; // 書いている間にまたいじられた
+        if (chunk.saveDirty) count++;
+        chunk.saveDirty = false;
+    }
+    cleanedCount += count;
+    return count;
+}
+
+int WorldSaver::failures() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return failedWrites;
+}
+
+bool WorldSaver::busy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return !queue.empty() || writing;
+}
+
+void WorldSaver::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        wake.wait(lock, [this] { return quit || !queue.empty(); });
+        if (queue.empty()) break; // quit でも残りは書いてから抜ける
+
+        std::vector<ChunkSnapshot> dirty = std::move(queue.front());
+        queue.pop_front();
+        writing = true;
+        lock.unlock();
+        bool written;
+        {
+            PROFILE_SCOPE("save");
+            written = file.writeChunks(dirty);
+        }
+        if (!written) std::cerr << "セーブに失敗しました (" << dirty.size() << " チャンク)。次のセーブでもう一度書きます" << std::endl;
+        lock.lock();
+        writing = false;
+        if (written)
+        {
+            for (const ChunkSnapshot& snap : dirty) saved.push_back({ snap.coord, snap.revision });
+        }
+        else
+        {
+            failedWrites++;
+        }
+        if (queue.empty()) idle.notify_all();
+    }
+    idle.notify_all();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "world.hpp"
+
+// セーブファイル (.mgw) の中身
+//   [ヘッダ]       "MGWD", バージョン, 索引の位置, チャンク数
+//   [チャンク本体] (個数 u16, 種類 u8) のランレングス圧縮をチャンクごとに
+//   [索引]         チャンク座標 -> 本体の位置と長さ
+// 数値はすべてリトルエンディアン。セーブのたびに変更のあったチャンクだけ
+// 末尾に追記し、新しい索引を書いてからヘッダの索引位置を書き換える。
+constexpr std::uint32_t WORLD_FILE_VERSION = 1;
+
+// セーブスレッドに渡すチャンクのコピー
+struct ChunkSnapshot {
+    ChunkCoord coord;
+    std::array<BlockId, CHUNK_VOLUME> blocks;
+    std::uint32_t revision = 0; // コピーしたときの Chunk::saveRevision
+};
+
+std::vector<std::uint8_t> encodeChunk(const std::array<BlockId, CHUNK_VOLUME>& blocks);
+bool decodeChunk(const std::uint8_t* data, std::size_t size, Chunk& out);
+
+// mmap したセーブファイル。チャンクは要求されたときに展開する
+class WorldFile : public ChunkSource {
+public:
+    explicit WorldFile(std::string path);
+    ~WorldFile() override;
+
+    WorldFile(const WorldFile&) = delete;
+    WorldFile& operator=(const WorldFile&) = delete;
+
+    // 既存のファイルを開いて索引を読む (無い・壊れているなら false で空のまま)
+    bool open();
+
+    bool hasChunk(const ChunkCoord& coord) const override;
+    bool loadChunk(const ChunkCoord& coord, Chunk& out) override;
+    std::vector<ChunkCoord> storedChunks() const override;
+
+    // 変更のあったチャンクを書き込む。同時に呼べるのは 1 スレッドだけ
+    bool writeChunks(const std::vector<ChunkSnapshot>& dirty);
+
+    std::size_t chunkCount() const;
+    std::uint64_t fileBytes() const;
+
+private:
+    struct IndexEntry {
+        std::uint64_t offset;
+        std::uint32_t size;
+    };
+    using Index = std::unordered_map<ChunkCoord, IndexEntry, ChunkCoordHash>;
+
+    bool appendChunks(const std::vector<ChunkSnapshot>& dirty);
+    bool rewriteAll(const std::vector<ChunkSnapshot>& dirty);
+    bool remap(Index newIndex); // mutex を取ってから呼ぶ
+    void unmap();
+
+    std::string path;
+    mutable std::mutex mutex; // index と mapped を守る
+
+    Index index;
+    const std::uint8_t* mapped = nullptr;
+    std::size_t mappedSize = 0;
+    std::uint64_t liveBytes = 0; // 索引から参照されている本体の合計
+};
+
+// バックグラウンドでセーブする
+class WorldSaver {
+public:
+    explicit WorldSaver(WorldFile& file);
+    ~WorldSaver(); // 残りを書き終えるまで待つ
+
+    WorldSaver(const WorldSaver&) = delete;
+    WorldSaver& operator=(const WorldSaver&) = delete;
+
+    // 変更のあったチャンクをコピーしてセーブスレッドに渡す (メインスレッドから呼ぶ)
+    // 戻り値は書き込むチャンク数。saveDirty はまだ落とさない
+    std::size_t requestSave(World& world);
+    // 書き終えたチャンクのうち、その後いじられていないものの saveDirty を落とす (メインスレッドから)
+    // 書き込みに失敗したものは dirty のままなので、次の requestSave でもう一度書く
+    std::size_t applySaved(World& world);
+    void wait();
+    // まだファイルに書き終えていないものがあるか
+    bool busy() const;
+    // 書き込みに失敗した回数
+    int failures() const;
+    // これまでに applySaved で saveDirty を落としたチャンク数
+    std::uint64_t cleanedChunks() const { return cleanedCount; }
+
+private:
+    void run();
+
+    WorldFile& file;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<std::vector<ChunkSnapshot>> queue;
+    std::vector<std::pair<ChunkCoord, std::uint32_t>> saved; // 書けたチャンクと版
+    int failedWrites = 0;
+    std::uint64_t cleanedCount = 0; // メインスレッドだけが触る
+    bool writing = false;
+    bool quit = false;
+    std::thread thread;
+};